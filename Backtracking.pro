@@ -53,6 +53,10 @@ DESTDIR = $$PWD
 # Ask Julie if you are curious why main->qMain->studentMain
 DEFINES += main=qMain qMain=studentMain
 
+# solver instrumentation (SolveProfile.h) is compiled out unless asked for:
+#   qmake CONFIG+=solver_profile
+solver_profile: DEFINES += PUZZLE_PROFILE
+
 ###############################################################################
 #       Gather files to list in Qt Creator project browser                    #
 ###############################################################################
@@ -68,6 +72,8 @@ HEADERS *= ""
 # Second argument true makes search recursive
 SOURCES *= $$files(*.cpp, true)
 HEADERS *= $$files(*.h, true)
+# headless tools in cli/ have their own main() and project files, keep them out
+SOURCES -= $$files(cli/*.cpp, true)
 
 # Gather resource files (image/sound/etc) from res dir, list under "Other files"
 OTHER_FILES *= $$files(res/*, true)
@@ -84,9 +90,9 @@ OTHER_FILES *= $$files(*.txt, true)
 
 CONFIG += sdk_no_version_check   # removes spurious warnings on Mac OS X
 
-# MinGW compiler lags, be conservative and use C++11 on all platforms
-# rather than special case
-CONFIG += c++11
+# C++17 on all platforms, same as the headless tools under cli/: the GUI
+# already relies on generic lambdas and the solver on if constexpr
+CONFIG += c++17
 
 # enable extra warnings
 QMAKE_CXXFLAGS_WARN_ON -= -Wall -Wextra -W
@@ -144,4 +150,4 @@ BAD_CHARS ~= s|[a-zA-Z0-9_ .\/:+-]+|
     error(Exiting. Project directory name contains invalid characters $$BAD_CHARS)
 }
 
-# END OF FILE (this should be line #147; if not, your .pro has been changed!)
+# END OF FILE (this should be line #149; if not, your .pro has been changed!)
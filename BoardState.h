@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+#include "Tile.h"
+#include "TileBitset.h"
+
+/**
+ * BoardStateOf
+ * ------------
+ * The mutable part of a Puzzle in a flat, trivially copyable block: the tile
+ * in each cell in row-major order (a Tile is five bytes of label ids and
+ * rotation, blank for an empty cell), the cells in the order they were
+ * filled, and the counts Puzzle keeps alongside. The grid size and the
+ * complement table are not part of it; they stay with the Puzzle, and a state
+ * can only be restored into a Puzzle of the same size.
+ *
+ * Boards of up to MaxCells cells fit. Copying a state is a plain memcpy, and
+ * the cells are laid out as Puzzle stores them, so snapshot and restore are
+ * straight copies too; a search can checkpoint a speculative branch or hand a
+ * board to another thread without allocating. BoardState covers boards up to
+ * 6x6 in 224 bytes, four cache lines; LargeBoardState covers any board the
+ * bitset engines accept.
+ *
+ * A cell holds the Tile itself rather than a one-byte tile id because a
+ * Puzzle is handed tiles by value and has no tile table; ids exist only in
+ * the engines, so a state of ids could not be restored by Puzzle alone.
+ */
+template <int MaxCells>
+struct BoardStateOf {
+    static const int kMaxCells = MaxCells;
+    static_assert(MaxCells <= 256, "placed holds cell indices in bytes");
+
+    Tile cells[MaxCells];        // row-major, only the first numRows * numCols are used
+    uint8_t placed[MaxCells];    // row-major cell indices, oldest placement first
+    uint16_t numRows = 0;
+    uint16_t numCols = 0;
+    uint16_t numFilled = 0;
+    uint16_t numInOrder = 0;
+
+    /**
+     * @brief fits: can a board of this size be held in this state type?
+     */
+    static bool fits(int numRows, int numCols) { return numRows * numCols <= MaxCells; }
+};
+
+typedef BoardStateOf<36> BoardState;
+typedef BoardStateOf<MAX_TILES> LargeBoardState;
+
+static_assert(std::is_trivially_copyable<BoardState>::value, "BoardState is copied with memcpy");
+static_assert(std::is_trivially_copyable<LargeBoardState>::value, "LargeBoardState is copied with memcpy");
+static_assert(sizeof(BoardState) <= 4 * 64, "BoardState should stay within four cache lines");
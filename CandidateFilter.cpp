@@ -0,0 +1,215 @@
+/*
+ * File: CandidateFilter.cpp
+ * -------------------------
+ * Layout of the pool and the comparison kernels of CandidateFilter. Every
+ * kernel walks the tile ids in blocks as wide as its registers, ANDs the
+ * byte-wise equality masks of the constrained sides and packs the result
+ * into bits. Tile ids past the end of the pool produce garbage bits, which
+ * are harmless because callers AND the result with a set of real ids.
+ */
+#include "CandidateFilter.h"
+#include "PuzzleConfig.h"
+#include "PuzzleGenerator.h"
+#include "error.h"
+#include "strlib.h"
+#include "SimpleTest.h"
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CANDIDATE_FILTER_X86
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+typedef uint8_t LabelTable[NUM_SIDES][NUM_SIDES][MAX_TILES];
+typedef uint64_t FitWords[NUM_SIDES][TileBitset::kNumWords];
+typedef void (*MatchKernel)(const LabelTable& labels, int numTiles, const int need[NUM_SIDES], FitWords& fits);
+
+static void matchScalar(const LabelTable& labels, int numTiles, const int need[NUM_SIDES], FitWords& fits) {
+    for (int turn = 0; turn < NUM_SIDES; turn++) {
+        for (int id = 0; id < numTiles; id++) {
+            bool fit = true;
+            for (int side = 0; side < NUM_SIDES && fit; side++) {
+                fit = need[side] == CandidateFilter::ANY || labels[turn][side][id] == need[side];
+            }
+            if (fit) fits[turn][id >> 6] |= uint64_t(1) << (id & 63);
+        }
+    }
+}
+
+#ifdef CANDIDATE_FILTER_X86
+__attribute__((target("sse2")))
+static void matchSse2(const LabelTable& labels, int numTiles, const int need[NUM_SIDES], FitWords& fits) {
+    for (int turn = 0; turn < NUM_SIDES; turn++) {
+        for (int base = 0; base < numTiles; base += 16) {
+            __m128i fit = _mm_set1_epi8(-1);
+            for (int side = 0; side < NUM_SIDES; side++) {
+                if (need[side] == CandidateFilter::ANY) continue;
+                __m128i shown = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&labels[turn][side][base]));
+                fit = _mm_and_si128(fit, _mm_cmpeq_epi8(shown, _mm_set1_epi8(char(need[side]))));
+            }
+            uint64_t bits = uint32_t(_mm_movemask_epi8(fit)) & 0xffff;
+            fits[turn][base >> 6] |= bits << (base & 63);
+        }
+    }
+}
+
+__attribute__((target("avx2")))
+static void matchAvx2(const LabelTable& labels, int numTiles, const int need[NUM_SIDES], FitWords& fits) {
+    for (int turn = 0; turn < NUM_SIDES; turn++) {
+        for (int base = 0; base < numTiles; base += 32) {
+            __m256i fit = _mm256_set1_epi8(-1);
+            for (int side = 0; side < NUM_SIDES; side++) {
+                if (need[side] == CandidateFilter::ANY) continue;
+                __m256i shown = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&labels[turn][side][base]));
+                fit = _mm256_and_si256(fit, _mm256_cmpeq_epi8(shown, _mm256_set1_epi8(char(need[side]))));
+            }
+            uint64_t bits = uint32_t(_mm256_movemask_epi8(fit));
+            fits[turn][base >> 6] |= bits << (base & 63);
+        }
+    }
+}
+#endif
+
+static const char* const kKernelNames[] = { "avx2", "sse2", "scalar" };  // fastest first
+
+// the kernel of that name, nullptr if the processor does not support it
+static MatchKernel kernelFor(const string& name) {
+#ifdef CANDIDATE_FILTER_X86
+    __builtin_cpu_init();
+    if (name == "avx2" && __builtin_cpu_supports("avx2")) return matchAvx2;
+    if (name == "sse2" && __builtin_cpu_supports("sse2")) return matchSse2;
+#endif
+    return (name == "scalar") ? matchScalar : nullptr;
+}
+
+// chosen once, from what the processor supports
+static MatchKernel chooseKernel(const char*& name) {
+    for (const char* candidate : kKernelNames) {
+        if (MatchKernel kernel = kernelFor(candidate)) {
+            name = candidate;
+            return kernel;
+        }
+    }
+    name = "scalar";
+    return matchScalar;
+}
+
+static const char* gKernelName = nullptr;
+static MatchKernel gKernel = chooseKernel(gKernelName);
+
+CandidateFilter::CandidateFilter(const Puzzle& puzzle, const Vector<Tile>& pool) : _numTiles(pool.size()), _labels{} {
+    if (_numTiles > MAX_TILES) error("Candidate filter supports at most " + integerToString(MAX_TILES) + " tiles");
+    for (int id = 0; id < _numTiles; id++) {
+        Tile tile = pool[id];
+        for (int turn = 0; turn < NUM_SIDES; turn++) {
+            for (Direction side = NORTH; side <= WEST; side++) {
+                _labels[turn][side][id] = puzzle.complementOf(tile.getEdgeId(side));
+            }
+            tile.rotate();
+        }
+    }
+}
+
+void CandidateFilter::match(const Puzzle& puzzle, GridLocation loc, TileBitset fits[NUM_SIDES]) const {
+    int need[NUM_SIDES];
+    for (Direction side = NORTH; side <= WEST; side++) {
+        GridLocation other;
+        need[side] = ANY;
+        if (!puzzle.neighbor(loc, side, other)) continue;
+        Tile neighbor = puzzle.tileAt(other);
+        if (!neighbor.isBlank()) need[side] = neighbor.getEdgeId(opposite(side));
+    }
+    match(need, fits);
+}
+
+void CandidateFilter::match(const int need[NUM_SIDES], TileBitset fits[NUM_SIDES]) const {
+    FitWords words = {};
+    gKernel(_labels, _numTiles, need, words);
+    for (int turn = 0; turn < NUM_SIDES; turn++) {
+        for (int w = 0; w < TileBitset::kNumWords; w++) {
+            fits[turn].setWord(w, words[turn][w]);
+        }
+    }
+}
+
+const char* CandidateFilter::kernelName() {
+    return gKernelName;
+}
+
+bool CandidateFilter::selectKernel(const string& name) {
+    for (const char* candidate : kKernelNames) {
+        if (name != candidate) continue;
+        MatchKernel kernel = kernelFor(candidate);
+        if (!kernel) return false;
+        gKernel = kernel;
+        gKernelName = candidate;
+        return true;
+    }
+    return false;
+}
+
+/* * * * * * Test Cases * * * * * */
+
+// every (tile, rotation) match reports for an empty cell is one canAdd accepts there, and the other way round
+static bool agreesWithCanAdd(const CandidateFilter& filter, const Puzzle& puzzle, const Vector<Tile>& pool) {
+    for (int row = 0; row < puzzle.numRows(); row++) {
+        for (int col = 0; col < puzzle.numCols(); col++) {
+            GridLocation loc(row, col);
+            if (!puzzle.tileAt(loc).isBlank()) continue;
+            TileBitset fits[NUM_SIDES];
+            filter.match(puzzle, loc, fits);
+            for (int id = 0; id < pool.size(); id++) {
+                Tile tile = pool[id];
+                for (int turn = 0; turn < NUM_SIDES; turn++) {
+                    if (fits[turn].contains(id) != puzzle.canAdd(tile, loc)) return false;
+                    tile.rotate();
+                }
+            }
+        }
+    }
+    return true;
+}
+
+/*
+ * Fills the board one cell at a time, out of row-major order and with tiles
+ * that need not match, and compares match with canAdd after every step.
+ */
+static bool agreesOnEveryStep(const Puzzle& puzzle, const Vector<Tile>& pool) {
+    CandidateFilter filter(puzzle, pool);
+    Puzzle board = puzzle;
+    int numCells = board.numRows() * board.numCols();
+    for (int step = 0; step < numCells; step++) {
+        if (!agreesWithCanAdd(filter, board, pool)) return false;
+        int cell = (step * 7) % numCells;  // 7 shares no factor with the board sizes used
+        Tile tile = pool[(step * 5) % pool.size()];
+        for (int turn = 0; turn < step % NUM_SIDES; turn++) {
+            tile.rotate();
+        }
+        board.add(tile, GridLocation(cell / board.numCols(), cell % board.numCols()));
+    }
+    return true;
+}
+
+STUDENT_TEST("every match kernel agrees with canAdd, including the scalar one") {
+    string original = CandidateFilter::kernelName();
+    int kernelsRun = 0;
+    for (const char* kernel : kKernelNames) {
+        if (!CandidateFilter::selectKernel(kernel)) continue;  // not on this processor
+        kernelsRun++;
+        for (string file : { "puzzles/turtles/turtles.txt", "puzzles/cola/cola.txt" }) {
+            Puzzle puzzle;
+            Vector<Tile> tiles;
+            string reason;
+            EXPECT(loadPuzzleFile(file, puzzle, tiles, reason));
+            EXPECT(agreesOnEveryStep(puzzle, tiles));
+        }
+        // 81 tiles cross the 16-, 32- and 64-tile block boundaries of the kernels
+        Puzzle puzzle;
+        Vector<Tile> tiles;
+        generatePuzzle(9, 9, 6, 3, puzzle, tiles);
+        EXPECT(agreesOnEveryStep(puzzle, tiles));
+    }
+    EXPECT(kernelsRun >= 1);
+    EXPECT(CandidateFilter::selectKernel(original));
+    EXPECT(!CandidateFilter::selectKernel("no-such-kernel"));
+}
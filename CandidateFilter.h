@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include "Puzzle.h"
+#include "Tile.h"
+#include "TileBitset.h"
+#include "vector.h"
+
+/**
+ * CandidateFilter
+ * ---------------
+ * Finds every (tile, rotation) of a pool that fits a cell in one data-parallel
+ * pass, instead of calling canAdd per candidate. The pool is stored as a
+ * structure of arrays: for each rotation and each side, one byte per tile id
+ * holding the complement of the label the tile shows on that side. A cell
+ * requires, on each side with a placed neighbor, the label that neighbor
+ * shows; canMatchEdge accepts exactly the tiles whose stored complement
+ * equals it, so one byte comparison per side and tile decides the fit.
+ *
+ * The comparisons run 32 tiles at a time with AVX2 where the processor has
+ * it, 16 at a time with SSE2 on other x86 processors, and one at a time
+ * elsewhere. The result is one TileBitset per rotation, to be combined with
+ * the bitset of tiles not yet placed.
+ */
+class CandidateFilter {
+public:
+    static const int ANY = -1;
+
+    /**
+     * @brief CandidateFilter lays out the tiles of pool, by id, using the
+     *        complement table of puzzle
+     */
+    CandidateFilter(const Puzzle& puzzle, const Vector<Tile>& pool);
+
+    /**
+     * @brief match sets fits[r] to the ids of the tiles that, turned r quarter
+     *        turns from their orientation in the pool, would match every placed
+     *        neighbor of the empty cell loc
+     */
+    void match(const Puzzle& puzzle, GridLocation loc, TileBitset fits[NUM_SIDES]) const;
+
+    /**
+     * @brief match (overloaded) takes the label each side must match, indexed by
+     *        Direction, ANY where the side is unconstrained
+     */
+    void match(const int need[NUM_SIDES], TileBitset fits[NUM_SIDES]) const;
+
+    /**
+     * @brief kernelName returns "avx2", "sse2" or "scalar", whichever match uses
+     */
+    static const char* kernelName();
+
+    /**
+     * @brief selectKernel makes match use the named kernel in place of the fastest
+     *        one, for tests and benchmarks. Not to be called while a search is
+     *        running on another thread
+     * @return false, leaving the kernel as it was, if the name is unknown or the
+     *         processor does not support that kernel
+     */
+    static bool selectKernel(const std::string& name);
+
+private:
+    int _numTiles;
+    alignas(32) uint8_t _labels[NUM_SIDES][NUM_SIDES][MAX_TILES];  // [rotation][side][tile id]
+};
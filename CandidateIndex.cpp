@@ -0,0 +1,80 @@
+/*
+ * File: CandidateIndex.cpp
+ * ------------------------
+ * Builds the (north, west) lookup table used by the indexed solver. Every
+ * candidate is filed under four keys: both labels exact, north exact with
+ * west ANY, north ANY with west exact, and both ANY. The table is laid out
+ * as one array of candidates with an offset per key (counting sort), so a
+ * lookup is two array reads.
+ */
+#include "CandidateIndex.h"
+
+using namespace std;
+
+CandidateIndex::CandidateIndex(const Puzzle& puzzle, const Vector<Tile>& pool) {
+    // keys must cover every label a neighbor can show and every complement
+    Vector<Candidate> all;
+    int maxLabel = 0;
+    for (int id = 0; id < pool.size(); id++) {
+        Tile tile = pool[id];
+        for (int r = 0; r < NUM_SIDES; r++) {
+            all.add({ uint16_t(id), tile });
+            maxLabel = max(maxLabel, int(tile.getEdgeId(NORTH)));
+            maxLabel = max(maxLabel, int(puzzle.complementOf(tile.getEdgeId(NORTH))));
+            tile.rotate();
+        }
+    }
+    _numKeys = maxLabel + 2;
+
+    // a candidate fits under the neighbor label that its own edge complements
+    auto keysOf = [this, &puzzle](const Candidate& c, int keys[4]) {
+        int north = puzzle.complementOf(c.tile.getEdgeId(NORTH));
+        int west = puzzle.complementOf(c.tile.getEdgeId(WEST));
+        keys[0] = keyFor(north, west);
+        keys[1] = keyFor(north, ANY);
+        keys[2] = keyFor(ANY, west);
+        keys[3] = keyFor(ANY, ANY);
+    };
+
+    _offsets = Vector<int>(_numKeys * _numKeys + 1, 0);
+    int keys[4];
+    for (const Candidate& c : all) {
+        keysOf(c, keys);
+        for (int key : keys) _offsets[key + 1]++;
+    }
+    for (int key = 0; key < _numKeys * _numKeys; key++) {
+        _offsets[key + 1] += _offsets[key];
+    }
+    _candidates = Vector<Candidate>(_offsets[_numKeys * _numKeys], Candidate());
+    Vector<int> next = _offsets;
+    for (const Candidate& c : all) {
+        keysOf(c, keys);
+        for (int key : keys) _candidates[next[key]++] = c;
+    }
+}
+
+const CandidateIndex::Candidate* CandidateIndex::candidatesAt(const Puzzle& puzzle, GridLocation loc, int& count) const {
+    int north = ANY, west = ANY;
+    if (loc.row > 0) {
+        Tile above = puzzle.tileAt(GridLocation(loc.row - 1, loc.col));
+        if (!above.isBlank()) north = above.getEdgeId(SOUTH);
+    }
+    if (loc.col > 0) {
+        Tile left = puzzle.tileAt(GridLocation(loc.row, loc.col - 1));
+        if (!left.isBlank()) west = left.getEdgeId(EAST);
+    }
+    return candidates(north, west, count);
+}
+
+bool CandidateIndex::canFillNeighbors(const Puzzle& puzzle, GridLocation loc, const TileBitset& remaining) const {
+    for (Direction dir = NORTH; dir <= WEST; dir++) {
+        GridLocation cell;
+        if (!puzzle.neighbor(loc, dir, cell) || !puzzle.tileAt(cell).isBlank()) continue;
+        int count;
+        const Candidate* run = candidatesAt(puzzle, cell, count);
+        int i = 0;
+        while (i < count && !remaining.contains(run[i].id)) i++;
+        if (i == count) return false;
+    }
+    return true;
+}
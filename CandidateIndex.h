@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstdint>
+#include "Puzzle.h"
+#include "Tile.h"
+#include "TileBitset.h"
+#include "vector.h"
+
+/**
+ * CandidateIndex
+ * --------------
+ * With the board filled in row-major order, the only neighbors of the next
+ * cell that are already placed are the ones to the north and west. This
+ * index maps the pair (south label of the north neighbor, east label of the
+ * west neighbor) to every (tile, rotation) whose north and west edges match
+ * them. Either label may be ANY when the neighbor is off the board or not
+ * placed yet. It is built once from the tile pool and then answers each
+ * lookup with a contiguous run of candidates, no edge checks needed.
+ */
+class CandidateIndex {
+public:
+    static const int ANY = -1;
+
+    /* A tile in one specific orientation, id is its index in the pool */
+    struct Candidate {
+        uint16_t id;
+        Tile tile;
+    };
+
+    /**
+     * @brief CandidateIndex builds the index for the tiles in pool, using the
+     *        complement table of puzzle to decide which edges match
+     */
+    CandidateIndex(const Puzzle& puzzle, const Vector<Tile>& pool);
+
+    /**
+     * @brief candidates returns the run of candidates for a cell whose north
+     *        neighbor shows northLabel on its south edge and whose west neighbor
+     *        shows westLabel on its east edge (either may be ANY)
+     * @param count: set to the number of candidates in the run
+     * @return pointer to the first candidate of the run
+     */
+    const Candidate* candidates(int northLabel, int westLabel, int& count) const {
+        if (northLabel >= _numKeys - 1 || westLabel >= _numKeys - 1) {
+            count = 0; // no tile in the pool complements a label this large
+            return nullptr;
+        }
+        int key = keyFor(northLabel, westLabel);
+        count = _offsets[key + 1] - _offsets[key];
+        return _candidates.isEmpty() ? nullptr : &_candidates[_offsets[key]];
+    }
+
+    /**
+     * @brief candidatesFor returns the candidates for the next cell to be
+     *        filled on puzzle, looking up its north and west neighbors
+     */
+    const Candidate* candidatesFor(const Puzzle& puzzle, int& count) const { return candidatesAt(puzzle, puzzle.nextLocation(), count); }
+
+    /**
+     * @brief candidatesAt returns the candidates for the cell loc on puzzle,
+     *        looking up its north and west neighbors
+     */
+    const Candidate* candidatesAt(const Puzzle& puzzle, GridLocation loc, int& count) const;
+
+    /**
+     * @brief canFillNeighbors is the forward check made after placing a tile at
+     *        loc: does every empty cell next to loc still have a candidate in
+     *        remaining that fits its north and west neighbors?
+     */
+    bool canFillNeighbors(const Puzzle& puzzle, GridLocation loc, const TileBitset& remaining) const;
+
+private:
+    int keyFor(int northLabel, int westLabel) const {
+        int n = (northLabel == ANY) ? _numKeys - 1 : northLabel;
+        int w = (westLabel == ANY) ? _numKeys - 1 : westLabel;
+        return n * _numKeys + w;
+    }
+
+    int _numKeys;               // label ids 0.._numKeys-2, last slot is ANY
+    Vector<int> _offsets;       // start of each key's run in _candidates, plus end sentinel
+    Vector<Candidate> _candidates;
+};
@@ -0,0 +1,233 @@
+/*
+ * File: DancingLinks.cpp
+ * ----------------------
+ * Algorithm X with dancing links, and the edge-matching exact cover model.
+ *
+ * Edge agreement is expressed with secondary columns. For an interior edge e
+ * between an earlier cell p (north or west) and a later cell q, there is one
+ * column (e, X) per label X. A row placing label L on p's side of e covers
+ * every (e, X) with X != L; a row placing label M on q's side covers only
+ * (e, complement of M). The two rows collide unless complement(M) == L, the
+ * same test Puzzle::canMatchEdge applies when q is added after p.
+ */
+#include "DancingLinks.h"
+#include "grid.h"
+
+using namespace std;
+
+DancingLinks::DancingLinks(int numPrimary, int numSecondary) : _numColumns(numPrimary + numSecondary), _numRows(0) {
+    // node 0 is the root, nodes 1.._numColumns are the column headers
+    for (int i = 0; i <= _numColumns; i++) {
+        _left.add(i - 1);
+        _right.add(i + 1);
+        _up.add(i);
+        _down.add(i);
+        _column.add(i);
+        _row.add(-1);
+        _size.add(0);
+    }
+    // primary headers form the circular list through the root, secondaries link to themselves
+    _left[0] = numPrimary;
+    _right[numPrimary] = 0;
+    for (int i = numPrimary + 1; i <= _numColumns; i++) {
+        _left[i] = _right[i] = i;
+    }
+}
+
+int DancingLinks::addRow(const Vector<int>& columns) {
+    int first = -1;
+    for (int col : columns) {
+        int header = col + 1;
+        int node = _left.size();
+        _column.add(header);
+        _row.add(_numRows);
+        _up.add(_up[header]);
+        _down.add(header);
+        _down[_up[header]] = node;
+        _up[header] = node;
+        _size[header]++;
+        if (first < 0) {
+            first = node;
+            _left.add(node);
+            _right.add(node);
+        } else {
+            _left.add(_left[first]);
+            _right.add(first);
+            _right[_left[first]] = node;
+            _left[first] = node;
+        }
+    }
+    return _numRows++;
+}
+
+void DancingLinks::cover(int col) {
+    _right[_left[col]] = _right[col];
+    _left[_right[col]] = _left[col];
+    for (int i = _down[col]; i != col; i = _down[i]) {
+        for (int j = _right[i]; j != i; j = _right[j]) {
+            _down[_up[j]] = _down[j];
+            _up[_down[j]] = _up[j];
+            _size[_column[j]]--;
+        }
+    }
+}
+
+void DancingLinks::uncover(int col) {
+    for (int i = _up[col]; i != col; i = _up[i]) {
+        for (int j = _left[i]; j != i; j = _left[j]) {
+            _size[_column[j]]++;
+            _down[_up[j]] = j;
+            _up[_down[j]] = j;
+        }
+    }
+    _right[_left[col]] = col;
+    _left[_right[col]] = col;
+}
+
+bool DancingLinks::searchFrom(Vector<int>& chosen, long& nodes) {
+    if (_right[0] == 0) return true;
+    int best = _right[0];
+    for (int col = _right[best]; col != 0; col = _right[col]) {
+        if (_size[col] < _size[best]) best = col;
+    }
+    if (_size[best] == 0) return false;
+    if (_cancel && _cancel->load(memory_order_relaxed)) {
+        _cancelled = true;
+        return false;
+    }
+    cover(best);
+    for (int r = _down[best]; r != best; r = _down[r]) {
+        nodes++;
+        chosen.add(_row[r]);
+        for (int j = _right[r]; j != r; j = _right[j]) cover(_column[j]);
+        bool found = searchFrom(chosen, nodes);
+        for (int j = _left[r]; j != r; j = _left[j]) uncover(_column[j]);
+        if (found) {
+            uncover(best); // leave the matrix intact for another search
+            return true;
+        }
+        chosen.removeBack();
+    }
+    uncover(best);
+    return false;
+}
+
+bool DancingLinks::search(Vector<int>& solution, long& nodes, const std::atomic<bool>* cancel) {
+    Vector<int> chosen;
+    _cancel = cancel;
+    _cancelled = false;
+    bool found = searchFrom(chosen, nodes);
+    _cancel = nullptr;
+    if (!found) return false;
+    solution = chosen;
+    return true;
+}
+
+/* ---- edge-matching model ---- */
+
+bool solveExactCover(Puzzle& puzzle, Vector<Tile>& tileVec, const SolveOptions& options) {
+    int numRows = puzzle.numRows(), numCols = puzzle.numCols();
+    Grid<int> cellColumn(numRows, numCols, -1);
+    Vector<GridLocation> emptyCells;
+    for (int row = 0; row < numRows; row++) {
+        for (int col = 0; col < numCols; col++) {
+            GridLocation loc(row, col);
+            if (!puzzle.tileAt(loc).isBlank()) continue;
+            cellColumn[loc] = emptyCells.size();
+            emptyCells.add(loc);
+        }
+    }
+    if (tileVec.size() < emptyCells.size()) return false;
+
+    // every label a tile shows, so (edge, label) columns cover all possibilities
+    Vector<LabelId> labels;
+    Vector<int> labelSlot(MAX_LABELS, -1);
+    for (Tile tile : tileVec) {
+        for (Direction dir = NORTH; dir <= WEST; dir++) {
+            LabelId id = tile.getEdgeId(dir);
+            if (labelSlot[id] < 0) {
+                labelSlot[id] = labels.size();
+                labels.add(id);
+            }
+        }
+    }
+    // interior edges between two empty cells: east edge then south edge of each cell
+    Grid<int> eastEdge(numRows, numCols, -1), southEdge(numRows, numCols, -1);
+    int numEdges = 0;
+    for (const GridLocation& loc : emptyCells) {
+        if (loc.col + 1 < numCols && cellColumn[GridLocation(loc.row, loc.col + 1)] >= 0) eastEdge[loc] = numEdges++;
+        if (loc.row + 1 < numRows && cellColumn[GridLocation(loc.row + 1, loc.col)] >= 0) southEdge[loc] = numEdges++;
+    }
+
+    // a spare tile may stay unused when there are more tiles than cells
+    bool tilesPrimary = tileVec.size() == emptyCells.size();
+    int numCells = emptyCells.size(), numTiles = tileVec.size(), numLabels = labels.size();
+    int numPrimary = numCells + (tilesPrimary ? numTiles : 0);
+    int tileBase = tilesPrimary ? numCells : numCells + numEdges * numLabels;
+    int edgeBase = tilesPrimary ? numCells + numTiles : numCells;
+    DancingLinks matrix(numPrimary, numTiles + numEdges * numLabels - (tilesPrimary ? numTiles : 0));
+
+    auto earlierSide = [&](Vector<int>& columns, int edge, LabelId label) {
+        for (int x = 0; x < numLabels; x++) {
+            if (labels[x] != label) columns.add(edgeBase + edge * numLabels + x);
+        }
+    };
+    auto laterSide = [&](Vector<int>& columns, int edge, LabelId label) {
+        int slot = labelSlot[puzzle.complementOf(label)];
+        if (slot < 0) return false; // no tile can ever match this edge
+        columns.add(edgeBase + edge * numLabels + slot);
+        return true;
+    };
+
+    Vector<GridLocation> rowCell;
+    Vector<Tile> rowTile;
+    Vector<int> rowTileId;
+    for (int id = 0; id < numTiles; id++) {
+        Tile tile = tileVec[id];
+        for (int r = 0; r < NUM_SIDES; r++) {
+            tile.rotate();
+            for (const GridLocation& loc : emptyCells) {
+                bool fits = true;
+                for (Direction dir = NORTH; dir <= WEST && fits; dir++) {
+                    fits = puzzle.canMatchEdge(tile, loc, dir);  // only placed neighbors can refuse
+                }
+                Vector<int> columns = { cellColumn[loc], tileBase + id };
+                if (eastEdge[loc] >= 0) earlierSide(columns, eastEdge[loc], tile.getEdgeId(EAST));
+                if (southEdge[loc] >= 0) earlierSide(columns, southEdge[loc], tile.getEdgeId(SOUTH));
+                if (loc.col > 0 && eastEdge[GridLocation(loc.row, loc.col - 1)] >= 0) {
+                    fits = fits && laterSide(columns, eastEdge[GridLocation(loc.row, loc.col - 1)], tile.getEdgeId(WEST));
+                }
+                if (loc.row > 0 && southEdge[GridLocation(loc.row - 1, loc.col)] >= 0) {
+                    fits = fits && laterSide(columns, southEdge[GridLocation(loc.row - 1, loc.col)], tile.getEdgeId(NORTH));
+                }
+                if (!fits) continue;
+                matrix.addRow(columns);
+                rowCell.add(loc);
+                rowTile.add(tile);
+                rowTileId.add(id);
+            }
+        }
+    }
+
+    Vector<int> solution;
+    long nodes = 0;
+    bool found = matrix.search(solution, nodes, options.cancel);
+    if (options.stats) {
+        options.stats->nodes += nodes;
+        options.stats->probes += matrix.numRows();
+        if (matrix.wasCancelled()) options.stats->cancelled = true;
+    }
+    if (!found) return false;
+
+    Vector<int> timesUsed(numTiles, 0);
+    for (int row : solution) {
+        puzzle.add(rowTile[row], rowCell[row]);
+        timesUsed[rowTileId[row]]++;
+    }
+    Vector<Tile> unused;
+    for (int id = 0; id < numTiles; id++) {
+        if (timesUsed[id] == 0) unused.add(tileVec[id]);
+    }
+    tileVec = unused;
+    return true;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <atomic>
+#include "Puzzle.h"
+#include "puzzle-solve.h"
+#include "vector.h"
+
+/**
+ * DancingLinks
+ * ------------
+ * Knuth's Algorithm X on a sparse 0/1 matrix stored as dancing links.
+ * Primary columns must be covered exactly once, secondary columns at most
+ * once (they are left out of the header list, so search never picks them).
+ * Nodes live in flat index arrays rather than separately allocated cells.
+ */
+class DancingLinks {
+public:
+    DancingLinks(int numPrimary, int numSecondary);
+
+    /**
+     * @brief addRow adds a row with a 1 in each of the given columns. Columns
+     *        0..numPrimary-1 are primary, the rest secondary
+     * @return the id of the new row, rows are numbered from 0 in order added
+     */
+    int addRow(const Vector<int>& columns);
+
+    /**
+     * @brief search runs Algorithm X, always branching on the primary column
+     *        with the fewest rows left
+     * @param solution: set to the ids of the chosen rows if a cover is found
+     * @param nodes: incremented once for each row tried
+     * @param cancel: if given, polled once per row tried; the search gives up
+     *        and returns false once it is set
+     * @return true if an exact cover was found
+     */
+    bool search(Vector<int>& solution, long& nodes, const std::atomic<bool>* cancel = nullptr);
+
+    int numRows() const { return _numRows; }
+
+    /**
+     * @brief wasCancelled: did the last search give up because cancel was set?
+     */
+    bool wasCancelled() const { return _cancelled; }
+
+private:
+    void cover(int col);
+    void uncover(int col);
+    bool searchFrom(Vector<int>& chosen, long& nodes);
+
+    int _numColumns;
+    int _numRows;
+    Vector<int> _left, _right, _up, _down;  // links, index 0.._numColumns are column headers
+    Vector<int> _column;                    // column of each node
+    Vector<int> _row;                       // row id of each node
+    Vector<int> _size;                      // live rows per column
+    const std::atomic<bool>* _cancel = nullptr;
+    bool _cancelled = false;
+};
+
+/**
+ * solveExactCover
+ * ---------------
+ * ENGINE_DLX. Models the puzzle as exact cover: one primary column per empty
+ * cell and per tile, rows for every (tile, rotation, cell) that agrees with
+ * the tiles already on the board, and secondary columns per (interior edge,
+ * label) that let two rows meet at an edge only if their labels complement.
+ * On success the board is filled and the placed tiles removed from tileVec.
+ */
+bool solveExactCover(Puzzle& puzzle, Vector<Tile>& tileVec, const SolveOptions& options);
@@ -0,0 +1,52 @@
+/*
+ * File: FixedSolver.cpp
+ * ---------------------
+ * The board sizes FixedSolver is instantiated for, and the lookup from a
+ * loaded puzzle's dimensions to its instantiation.
+ */
+#include "FixedSolver.h"
+#include "error.h"
+
+using namespace std;
+
+template <int Rows, int Cols>
+static bool solveSized(Puzzle& puzzle, Vector<Tile>& tileVec, const SolveOptions& options) {
+    FixedSolver<Rows, Cols> solver(puzzle, tileVec, options);
+    if (!solver.solve()) return false;
+    solver.copyTo(puzzle);
+    tileVec.clear(); // every tile is now on the board
+    return true;
+}
+
+struct FixedSize {
+    int rows;
+    int cols;
+    bool (*solve)(Puzzle&, Vector<Tile>&, const SolveOptions&);
+};
+
+static const FixedSize kFixedSizes[] = {
+    { 2, 2, solveSized<2, 2> }, { 3, 3, solveSized<3, 3> }, { 4, 4, solveSized<4, 4> },
+    { 1, 2, solveSized<1, 2> }, { 1, 3, solveSized<1, 3> }, { 1, 4, solveSized<1, 4> }, { 1, 5, solveSized<1, 5> },
+    { 1, 6, solveSized<1, 6> }, { 1, 7, solveSized<1, 7> }, { 1, 8, solveSized<1, 8> },
+    { 2, 1, solveSized<2, 1> }, { 3, 1, solveSized<3, 1> }, { 4, 1, solveSized<4, 1> }, { 5, 1, solveSized<5, 1> },
+    { 6, 1, solveSized<6, 1> }, { 7, 1, solveSized<7, 1> }, { 8, 1, solveSized<8, 1> },
+};
+
+static const FixedSize* fixedSizeFor(int numRows, int numCols) {
+    for (const FixedSize& size : kFixedSizes) {
+        if (size.rows == numRows && size.cols == numCols) return &size;
+    }
+    return nullptr;
+}
+
+bool hasFixedSolver(int numRows, int numCols) {
+    return fixedSizeFor(numRows, numCols) != nullptr;
+}
+
+bool solveFixed(Puzzle& puzzle, Vector<Tile>& tileVec, const SolveOptions& options) {
+    const FixedSize* size = fixedSizeFor(puzzle.numRows(), puzzle.numCols());
+    if (!size || !puzzle.isEmpty() || tileVec.size() != puzzle.numRows() * puzzle.numCols()) {
+        error("No fixed-size solver for this board");
+    }
+    return size->solve(puzzle, tileVec, options);
+}
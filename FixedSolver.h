@@ -0,0 +1,166 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include "Puzzle.h"
+#include "Tile.h"
+#include "puzzle-solve.h"
+#include "vector.h"
+
+/**
+ * FixedSolver
+ * -----------
+ * Row-major backtracker for a board whose size is a template parameter.
+ * The board is a pair of std::arrays holding the south and east label of
+ * each placed tile, the tiles are a 64-bit mask, and whether a cell has a
+ * north or west neighbor comes from constexpr tables. Each cell is filled by
+ * its own instantiation of fill<Cell>, so the neighbor tests compile down to
+ * straight-line code with no bounds checks and the whole search can be
+ * inlined and unrolled. The matching rules are those of Puzzle::canMatchEdge.
+ *
+ * The solver works on copies of the tiles and writes the solution into the
+ * Puzzle only once one is found. The observer is not called.
+ */
+template <int Rows, int Cols>
+class FixedSolver {
+public:
+    static constexpr int kCells = Rows * Cols;
+    static_assert(kCells <= 64, "the unused tiles are kept in a 64-bit mask");
+
+    /**
+     * @brief FixedSolver copies the complement table of puzzle, which must be
+     *        empty and Rows x Cols, and the kCells tiles
+     */
+    FixedSolver(const Puzzle& puzzle, const Vector<Tile>& tiles, const SolveOptions& options)
+        : _tiles(tiles), _options(options), _unused(0), _nodes(0), _probes(0) {
+        for (int label = 0; label < MAX_LABELS; label++) {
+            _complement[label] = puzzle.complementOf(label);
+        }
+        for (int id = 0; id < kCells; id++) {
+            Tile tile = tiles[id];
+            for (int turn = 0; turn < NUM_SIDES; turn++) {
+                for (Direction dir = NORTH; dir <= WEST; dir++) {
+                    _turns[id][turn].edges[dir] = tile.getEdgeId(dir);
+                }
+                tile.rotate();
+            }
+            _blankTile[id] = tiles[id].isBlank();
+            _unused |= uint64_t(1) << id;
+        }
+    }
+
+    /**
+     * @brief solve searches for a solution and adds its counts to options.stats
+     * @return true if one was found
+     */
+    bool solve() {
+        bool found = fill<0>();
+        if (_options.stats) {
+            _options.stats->nodes += _nodes;
+            _options.stats->probes += _probes;
+        }
+        return found;
+    }
+
+    /**
+     * @brief copyTo adds the solution found by solve to puzzle in row-major order
+     */
+    void copyTo(Puzzle& puzzle) const {
+        for (int cell = 0; cell < kCells; cell++) {
+            Tile tile = _tiles[_tileAt[cell]];
+            for (int turn = 0; turn < _turnAt[cell]; turn++) tile.rotate();
+            puzzle.add(tile);
+        }
+    }
+
+private:
+    struct Orientation {
+        LabelId edges[NUM_SIDES];
+    };
+
+    static constexpr std::array<bool, kCells> northTable() {
+        std::array<bool, kCells> table{};
+        for (int cell = 0; cell < kCells; cell++) table[cell] = cell >= Cols;
+        return table;
+    }
+
+    static constexpr std::array<bool, kCells> westTable() {
+        std::array<bool, kCells> table{};
+        for (int cell = 0; cell < kCells; cell++) table[cell] = cell % Cols != 0;
+        return table;
+    }
+
+    static constexpr std::array<bool, kCells> kHasNorth = northTable();
+    static constexpr std::array<bool, kCells> kHasWest = westTable();
+
+    bool isCancelled() const {
+        return cancelRequested(_options);
+    }
+
+    template <int Cell>
+    bool fill() {
+        if constexpr (Cell == kCells) {
+            return true;
+        } else {
+            if (isCancelled()) return false;
+            for (uint64_t bits = _unused; bits; bits &= bits - 1) {
+                int id = __builtin_ctzll(bits);
+                for (int turn = 0; turn < NUM_SIDES; turn++) {
+                    const Orientation& tile = _turns[id][turn];
+                    _probes++;
+                    if constexpr (kHasNorth[Cell]) {
+                        if (!_blankAt[Cell - Cols] && _complement[tile.edges[NORTH]] != _south[Cell - Cols]) continue;
+                    }
+                    if constexpr (kHasWest[Cell]) {
+                        if (!_blankAt[Cell - 1] && _complement[tile.edges[WEST]] != _east[Cell - 1]) continue;
+                    }
+                    _unused &= ~(uint64_t(1) << id);
+                    _tileAt[Cell] = id;
+                    _turnAt[Cell] = turn;
+                    _south[Cell] = tile.edges[SOUTH];
+                    _east[Cell] = tile.edges[EAST];
+                    _blankAt[Cell] = _blankTile[id];
+                    _nodes++;
+                    if (fill<Cell + 1>()) return true;
+                    _unused |= uint64_t(1) << id;
+                }
+            }
+            return false;
+        }
+    }
+
+    const Vector<Tile>& _tiles;
+    const SolveOptions& _options;
+    std::array<LabelId, MAX_LABELS> _complement;
+    std::array<std::array<Orientation, NUM_SIDES>, kCells> _turns;  // by tile id, then quarter turns
+    std::array<bool, kCells> _blankTile;  // by tile id, blank tiles match anything
+    uint64_t _unused;
+
+    // the board, by cell in row-major order
+    std::array<uint8_t, kCells> _tileAt;
+    std::array<uint8_t, kCells> _turnAt;
+    std::array<LabelId, kCells> _south;
+    std::array<LabelId, kCells> _east;
+    std::array<bool, kCells> _blankAt;
+
+    long _nodes;
+    long _probes;
+};
+
+/**
+ * hasFixedSolver
+ * --------------
+ * Is there a FixedSolver instantiation for this board size? The compiled-in
+ * sizes are 2x2, 3x3, 4x4 and strips of 2 to 8 tiles in either direction.
+ */
+bool hasFixedSolver(int numRows, int numCols);
+
+/**
+ * solveFixed
+ * ----------
+ * ENGINE_FIXED. Runs the FixedSolver instantiated for the size of puzzle,
+ * which must be empty, with one tile in tileVec per cell and a size for which
+ * hasFixedSolver is true. On success the board is filled and tileVec emptied.
+ */
+bool solveFixed(Puzzle& puzzle, Vector<Tile>& tileVec, const SolveOptions& options);
@@ -0,0 +1,227 @@
+/*
+ * File: IterativeSearch.cpp
+ * -------------------------
+ * Explicit-stack version of the indexed search in puzzle-solve.cpp. Placing a
+ * candidate pushes a frame for the next cell; running out of candidates pops
+ * back to the previous frame, which takes its tile off the board and moves
+ * its cursor on. The frames are the only search state.
+ */
+#include "IterativeSearch.h"
+#include "PuzzleConfig.h"
+#include "PuzzleGenerator.h"
+#include "SimpleTest.h"
+
+using namespace std;
+
+IterativeSearch::IterativeSearch(Puzzle& puzzle, const Vector<Tile>& tiles, const SolveOptions& options,
+                                 NogoodTable* nogoods)
+    : _puzzle(puzzle),
+      _options(options),
+      _pool(tiles),
+      _index(puzzle, tiles),
+      _nogoods(nogoods),
+      _placements(0),
+      _checkEdges(!puzzle.isFilledInOrder()),
+      _frames(puzzle.numRows() * puzzle.numCols() - puzzle.numFilled() + 1),
+      _depth(0),
+      _status(SEARCHING) {
+    for (int id = 0; id < tiles.size(); id++) {
+        _remaining.add(id);
+    }
+    if (puzzle.isFull()) _status = SOLVED;  // any tiles still in _remaining are spares
+    else enter();
+}
+
+// starts the frame at _depth on the next cell to fill
+void IterativeSearch::enter() {
+    Frame& frame = _frames[_depth];
+    frame.cursor = -1;
+    frame.placementsAtEntry = -1;
+    if (_puzzle.isFull()) {
+        frame.run = nullptr;
+        frame.count = 0;
+        return;
+    }
+    frame.cell = _puzzle.nextLocation();
+    frame.run = _index.candidatesFor(_puzzle, frame.count);
+    if (_nogoods && !_checkEdges) {
+        if (_nogoods->contains(_puzzle, _remaining)) frame.count = 0;  // known dead end
+        else frame.placementsAtEntry = _placements;
+    }
+}
+
+// the frame at _depth has run out of candidates, its position, on the board again, is a dead end
+void IterativeSearch::leave() {
+    const Frame& frame = _frames[_depth];
+    if (frame.placementsAtEntry >= 0) {
+        _nogoods->record(_puzzle, _remaining, _placements - frame.placementsAtEntry);
+    }
+}
+
+void IterativeSearch::notify() const {
+    Vector<Tile> tiles;
+    for (int id = 0; id < _pool.size(); id++) {
+        if (_remaining.contains(id)) tiles.add(_pool[id]);
+    }
+    _options.observer(_puzzle, tiles);
+}
+
+// takes every tile the search placed back off the board
+void IterativeSearch::unwind() {
+    while (_depth > 0) {
+        _depth--;
+        _puzzle.remove();
+        _remaining.add(_frames[_depth].tileId());
+    }
+    if (_options.observer) notify();
+}
+
+IterativeSearch::Status IterativeSearch::run(long maxNodes) {
+    long nodes = 0;
+    while (_status == SEARCHING) {
+        if (cancelRequested(_options)) {
+            unwind();
+            _status = CANCELLED;
+            break;
+        }
+        Frame& frame = _frames[_depth];
+        bool placed = false;
+        while (!placed && ++frame.cursor < frame.count) {
+            const CandidateIndex::Candidate& candidate = frame.run[frame.cursor];
+            if (!_remaining.contains(candidate.id)) continue;
+            if (_options.stats) _options.stats->probes++;
+            if (_checkEdges && !_puzzle.canAdd(candidate.tile)) continue;
+            _remaining.remove(candidate.id);
+            _puzzle.add(candidate.tile);
+            _placements++;
+            placed = true;
+        }
+        if (placed) {
+            if (_options.stats) _options.stats->nodes++;
+            if (_options.observer) notify();
+            if (_puzzle.isFull()) {
+                _depth++;
+                _status = SOLVED;
+                break;
+            }
+            if (_options.forwardCheck && !_index.canFillNeighbors(_puzzle, frame.cell, _remaining)) {
+                _puzzle.remove();  // dead end, try the next candidate for this cell
+                _remaining.add(frame.tileId());
+                if (_options.observer) notify();
+            } else {
+                _depth++;
+                enter();
+            }
+            if (maxNodes > 0 && ++nodes == maxNodes) break;
+        } else if (_depth == 0) {
+            leave();
+            _status = EXHAUSTED;  // nothing of ours is left on the board
+        } else {
+            leave();
+            _depth--;
+            _puzzle.remove();
+            _remaining.add(_frames[_depth].tileId());
+            if (_options.observer) notify();
+        }
+    }
+    return _status;
+}
+
+// runs search to the end, on success leaving only the tiles it did not place in tileVec
+static bool runToEnd(IterativeSearch& search, Vector<Tile>& tileVec) {
+    if (search.run() != IterativeSearch::SOLVED) return false;
+    Vector<Tile> unplaced;
+    for (int id = 0; id < tileVec.size(); id++) {
+        if (search.remaining().contains(id)) unplaced.add(tileVec[id]);
+    }
+    tileVec = unplaced;
+    return true;
+}
+
+bool solveIterative(Puzzle& puzzle, Vector<Tile>& tileVec, const SolveOptions& options) {
+    if (options.nogoodKb <= 0) {
+        IterativeSearch search(puzzle, tileVec, options);
+        return runToEnd(search, tileVec);
+    }
+    NogoodTable nogoods(options.nogoodKb, puzzle.numCols());
+    IterativeSearch search(puzzle, tileVec, options, &nogoods);
+    bool found = runToEnd(search, tileVec);
+    if (options.stats) options.stats->nogoods += nogoods.stats();
+    return found;
+}
+
+/* * * * * * Test Cases * * * * * */
+
+// solves a copy of puzzle with engine, returning the board and the nodes it placed
+static long solveWith(SolveEngine engine, const Puzzle& puzzle, const Vector<Tile>& tiles, Puzzle& board, bool& solved) {
+    board = puzzle;
+    Vector<Tile> remaining = tiles;
+    SolveStats stats;
+    SolveOptions options;
+    options.engine = engine;
+    options.stats = &stats;
+    solved = solve(board, remaining, options);
+    return stats.nodes;
+}
+
+static bool sameBoard(const Puzzle& one, const Puzzle& two) {
+    for (int row = 0; row < one.numRows(); row++) {
+        for (int col = 0; col < one.numCols(); col++) {
+            Tile a = one.tileAt({ row, col }), b = two.tileAt({ row, col });
+            if (!(a == b) || a.getRotation() != b.getRotation()) return false;
+        }
+    }
+    return true;
+}
+
+STUDENT_TEST("iterative engine does the same search as the indexed engine") {
+    Vector<Puzzle> puzzles;
+    Vector<Vector<Tile>> pools;
+    for (string file : { "puzzles/turtles/turtles.txt", "puzzles/cola/cola.txt" }) {
+        Puzzle puzzle;
+        Vector<Tile> tiles;
+        string reason;
+        EXPECT(loadPuzzleFile(file, puzzle, tiles, reason));
+        puzzles.add(puzzle);
+        pools.add(tiles);
+    }
+    // the same cola with two sides of one tile swapped, which has no solution
+    Vector<Tile> broken = pools[1];
+    Tile first = broken[0];
+    broken[0] = Tile(first.getEdgeId(NORTH), first.getEdgeId(EAST), first.getEdgeId(WEST), first.getEdgeId(SOUTH));
+    puzzles.add(puzzles[1]);
+    pools.add(broken);
+    for (int i = 0; i < puzzles.size(); i++) {
+        Puzzle indexedBoard, iterativeBoard;
+        bool indexedSolved, iterativeSolved;
+        long indexedNodes = solveWith(ENGINE_INDEXED, puzzles[i], pools[i], indexedBoard, indexedSolved);
+        long iterativeNodes = solveWith(ENGINE_ITERATIVE, puzzles[i], pools[i], iterativeBoard, iterativeSolved);
+        EXPECT_EQUAL(iterativeSolved, indexedSolved);
+        EXPECT_EQUAL(iterativeNodes, indexedNodes);
+        EXPECT(sameBoard(iterativeBoard, indexedBoard));
+    }
+}
+
+STUDENT_TEST("iterative search paused every few nodes ends where an unbroken run does") {
+    Puzzle puzzle;
+    Vector<Tile> tiles;
+    generatePuzzle(5, 5, 4, 2, puzzle, tiles);
+    Puzzle whole = puzzle, paused = puzzle;
+    SolveStats wholeStats, pausedStats;
+    SolveOptions options;
+    options.stats = &wholeStats;
+    IterativeSearch unbroken(whole, tiles, options);
+    EXPECT_EQUAL(unbroken.run(0), IterativeSearch::SOLVED);  // 0 is no limit
+
+    options.stats = &pausedStats;
+    IterativeSearch search(paused, tiles, options);
+    int pauses = 0;
+    while (search.run(7) == IterativeSearch::SEARCHING) {
+        pauses++;
+        EXPECT(search.depth() == paused.numFilled());
+    }
+    EXPECT_EQUAL(search.status(), IterativeSearch::SOLVED);
+    EXPECT_EQUAL(pausedStats.nodes, wholeStats.nodes);
+    EXPECT_EQUAL(pauses, (wholeStats.nodes - 1) / 7);
+    EXPECT(sameBoard(paused, whole));
+}
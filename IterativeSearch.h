@@ -0,0 +1,100 @@
+#pragma once
+
+#include "CandidateIndex.h"
+#include "NogoodTable.h"
+#include "Puzzle.h"
+#include "TileBitset.h"
+#include "puzzle-solve.h"
+#include "vector.h"
+
+/**
+ * IterativeSearch
+ * ---------------
+ * The indexed row-major search without recursion. Each level of the search
+ * is a Frame in an array allocated once for every empty cell, so memory does
+ * not grow with depth and no C++ stack frame is used per tile. Because the
+ * whole state is in the frames, a search can be run for a bounded number of
+ * nodes, inspected, and resumed where it left off:
+ *
+ *     IterativeSearch search(puzzle, tiles, options);
+ *     while (search.run(100000) == IterativeSearch::SEARCHING) {
+ *         cout << search.depth() << " tiles deep" << endl;
+ *     }
+ */
+class IterativeSearch {
+public:
+    enum Status { SEARCHING, SOLVED, EXHAUSTED, CANCELLED };
+
+    /* One level of the search: the cell it fills, the run of candidates the
+     * index lists for that cell, and the cursor of the one now on the board */
+    struct Frame {
+        GridLocation cell;
+        const CandidateIndex::Candidate* run;
+        int count;
+        int cursor;  // -1 before the first candidate is placed
+        long placementsAtEntry;  // with a nogood table, -1 if the position is not to be recorded
+
+        int tileId() const { return run[cursor].id; }
+        int rotation() const { return run[cursor].tile.getRotation(); }
+    };
+
+    /**
+     * @brief IterativeSearch prepares a search of tiles into the empty cells of
+     *        puzzle, which is modified in place as the search runs
+     * @param nogoods: if given, positions that fail are recorded there and
+     *        positions found there are not searched again
+     */
+    IterativeSearch(Puzzle& puzzle, const Vector<Tile>& tiles, const SolveOptions& options,
+                    NogoodTable* nogoods = nullptr);
+
+    /**
+     * @brief run continues the search until it is solved, exhausted, cancelled
+     *        through options.cancel, or maxNodes more tiles have been placed
+     * @param maxNodes: budget for this call, zero or negative for no limit
+     * @return SEARCHING if the budget ran out and run may be called again. On
+     *         SOLVED the board is full; on EXHAUSTED and CANCELLED it is back to
+     *         how it was handed in
+     */
+    Status run(long maxNodes = -1);
+
+    Status status() const { return _status; }
+
+    /**
+     * @brief remaining returns the ids of the tiles not on the board. Once
+     *        SOLVED these are the spares, if there were more tiles than cells
+     */
+    const TileBitset& remaining() const { return _remaining; }
+
+    /**
+     * @brief depth returns the number of frames with a tile on the board,
+     *        frame(0) being the first cell the search filled
+     */
+    int depth() const { return _depth; }
+    const Frame& frame(int level) const { return _frames[level]; }
+
+private:
+    void enter();
+    void leave();
+    void notify() const;
+    void unwind();
+
+    Puzzle& _puzzle;
+    const SolveOptions& _options;
+    Vector<Tile> _pool;      // tile ids index this
+    CandidateIndex _index;
+    NogoodTable* _nogoods;
+    long _placements;
+    TileBitset _remaining;
+    bool _checkEdges;        // cells east or south of the next cell may be filled
+    Vector<Frame> _frames;   // one per empty cell plus one past the last, allocated up front
+    int _depth;              // frames in use; _frames[_depth] is being searched
+    Status _status;
+};
+
+/**
+ * solveIterative
+ * --------------
+ * ENGINE_ITERATIVE. Runs an IterativeSearch to completion. On success the
+ * board is filled and tileVec keeps only the tiles that were not placed.
+ */
+bool solveIterative(Puzzle& puzzle, Vector<Tile>& tileVec, const SolveOptions& options);
@@ -0,0 +1,349 @@
+/*
+ * File: LocalSearch.cpp
+ * ---------------------
+ * Parallel tempering over tile arrangements. The tiles are numbered by their
+ * position in the Vector handed in and the empty cells, then the spare tiles,
+ * are numbered as slots; a replica is an assignment of one tile and turn to
+ * each slot. Each replica keeps the labels shown in every cell so that a move
+ * is rescored from the four edges around each tile it moved.
+ */
+#include "LocalSearch.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <vector>
+#include "PuzzleConfig.h"
+#include "puzzle-solve.h"
+#include "WorkStealingPool.h"
+#include "error.h"
+#include "SimpleTest.h"
+
+using namespace std;
+
+static const double kEpochMs = 5;               // replicas run this long between exchanges
+static const int kMovesPerClockCheck = 1024;
+
+typedef array<LabelId, NUM_SIDES> Edges;
+
+/* What the replicas share: the cells to fill, each tile at each turn, who
+ * neighbours whom, and the labels of the tiles that were already placed */
+struct AnnealLayout {
+    int numCols;
+    Vector<int> freeCells;      // slot s < freeCells.size() fills row-major cell freeCells[s]
+    int numSlots;               // empty cells, then one per spare tile
+    vector<Edges> turns;        // [tile * NUM_SIDES + turn]
+    vector<uint8_t> blankTile;  // by tile id, blank tiles match anything
+    vector<array<int, NUM_SIDES>> neighbor;  // by cell and direction, -1 past the border
+    vector<Edges> edges;        // by cell, for the tiles already placed
+    vector<uint8_t> blank;      // by cell, true while empty or for a placed blank tile
+    LabelId complement[MAX_LABELS];
+};
+
+struct Replica {
+    vector<int> tileAt;        // by slot
+    vector<uint8_t> turnAt;    // by slot
+    vector<Edges> edges;       // by cell, the labels shown
+    vector<uint8_t> blank;     // by cell
+    int score = 0;
+    double temperature = 1;
+    vector<int> bestTileAt;
+    vector<uint8_t> bestTurnAt;
+    int bestScore = -1;
+    mt19937 rng;
+    long moves = 0;
+};
+
+static bool edgeMatches(const AnnealLayout& layout, const Replica& replica, int cell, Direction dir) {
+    int other = layout.neighbor[cell][dir];
+    return replica.blank[cell] || replica.blank[other]
+           || layout.complement[replica.edges[cell][dir]] == replica.edges[other][opposite(dir)];
+}
+
+static int scoreAround(const AnnealLayout& layout, const Replica& replica, int cell) {
+    int matched = 0;
+    for (Direction dir = NORTH; dir <= WEST; dir++) {
+        if (layout.neighbor[cell][dir] >= 0 && edgeMatches(layout, replica, cell, dir)) matched++;
+    }
+    return matched;
+}
+
+// matched edges touching the tiles in slots a and b (b may be -1), each edge counted once
+static int scoreSlots(const AnnealLayout& layout, const Replica& replica, int a, int b) {
+    int numFree = layout.freeCells.size();
+    int cellA = (a < numFree) ? layout.freeCells[a] : -1;
+    int cellB = (b >= 0 && b < numFree) ? layout.freeCells[b] : -1;
+    int matched = 0;
+    if (cellA >= 0) matched += scoreAround(layout, replica, cellA);
+    if (cellB >= 0) {
+        matched += scoreAround(layout, replica, cellB);
+        for (Direction dir = NORTH; cellA >= 0 && dir <= WEST; dir++) {
+            if (layout.neighbor[cellA][dir] == cellB && edgeMatches(layout, replica, cellA, dir)) matched--;
+        }
+    }
+    return matched;
+}
+
+static void place(const AnnealLayout& layout, Replica& replica, int slot, int tile, int turn) {
+    replica.tileAt[slot] = tile;
+    replica.turnAt[slot] = turn;
+    if (slot < layout.freeCells.size()) {
+        int cell = layout.freeCells[slot];
+        replica.edges[cell] = layout.turns[tile * NUM_SIDES + turn];
+        replica.blank[cell] = layout.blankTile[tile];
+    }
+}
+
+static void swapSlots(const AnnealLayout& layout, Replica& replica, int a, int b) {
+    int tile = replica.tileAt[a], turn = replica.turnAt[a];
+    place(layout, replica, a, replica.tileAt[b], replica.turnAt[b]);
+    place(layout, replica, b, tile, turn);
+}
+
+static int scoreBoard(const AnnealLayout& layout, const Replica& replica) {
+    int matched = 0;
+    for (int cell = 0; cell < (int)layout.neighbor.size(); cell++) {
+        if (layout.neighbor[cell][EAST] >= 0 && edgeMatches(layout, replica, cell, EAST)) matched++;
+        if (layout.neighbor[cell][SOUTH] >= 0 && edgeMatches(layout, replica, cell, SOUTH)) matched++;
+    }
+    return matched;
+}
+
+static void keepBest(Replica& replica) {
+    replica.bestScore = replica.score;
+    replica.bestTileAt = replica.tileAt;
+    replica.bestTurnAt = replica.turnAt;
+}
+
+// makes random moves until deadline, or until every edge matches or cancel is set
+static void runReplica(const AnnealLayout& layout, Replica& replica, int totalEdges,
+                       chrono::steady_clock::time_point deadline, const atomic<bool>* cancel) {
+    int numFree = layout.freeCells.size();
+    uniform_int_distribution<int> anyFree(0, numFree - 1), anySlot(0, layout.numSlots - 1), anyTurn(1, NUM_SIDES - 1);
+    uniform_real_distribution<double> unit(0, 1);
+    while (replica.bestScore < totalEdges) {
+        for (int i = 0; i < kMovesPerClockCheck; i++) {
+            replica.moves++;
+            int a = anyFree(replica.rng), b = -1;
+            if (layout.numSlots > 1 && (replica.rng() & 1)) {
+                do b = anySlot(replica.rng); while (b == a);
+            }
+            int before = scoreSlots(layout, replica, a, b);
+            int oldTurn = replica.turnAt[a];
+            if (b < 0) place(layout, replica, a, replica.tileAt[a], (oldTurn + anyTurn(replica.rng)) % NUM_SIDES);
+            else swapSlots(layout, replica, a, b);
+            int delta = scoreSlots(layout, replica, a, b) - before;
+            if (delta < 0 && unit(replica.rng) >= exp(delta / replica.temperature)) {
+                if (b < 0) place(layout, replica, a, replica.tileAt[a], oldTurn);
+                else swapSlots(layout, replica, a, b);
+                continue;
+            }
+            replica.score += delta;
+            if (replica.score > replica.bestScore) keepBest(replica);
+        }
+        if (chrono::steady_clock::now() >= deadline) return;
+        if (cancel && cancel->load(memory_order_relaxed)) return;
+    }
+}
+
+static void buildLayout(const Puzzle& puzzle, const Vector<Tile>& tiles, AnnealLayout& layout) {
+    int numRows = puzzle.numRows(), numCols = puzzle.numCols();
+    layout.numCols = numCols;
+    layout.neighbor.resize(numRows * numCols);
+    layout.edges.resize(numRows * numCols);
+    layout.blank.resize(numRows * numCols);
+    for (int cell = 0; cell < numRows * numCols; cell++) {
+        GridLocation loc(cell / numCols, cell % numCols);
+        Tile tile = puzzle.tileAt(loc);
+        for (Direction dir = NORTH; dir <= WEST; dir++) {
+            GridLocation other;
+            layout.neighbor[cell][dir] = puzzle.neighbor(loc, dir, other) ? other.row * numCols + other.col : -1;
+            layout.edges[cell][dir] = tile.getEdgeId(dir);
+        }
+        layout.blank[cell] = tile.isBlank();
+        if (tile.isBlank()) layout.freeCells.add(cell);
+    }
+    if (tiles.size() < layout.freeCells.size()) error("Not enough tiles to fill the board");
+    layout.numSlots = tiles.size();
+    layout.turns.resize(tiles.size() * NUM_SIDES);
+    layout.blankTile.resize(tiles.size());
+    for (int id = 0; id < tiles.size(); id++) {
+        Tile tile = tiles[id];
+        for (int turn = 0; turn < NUM_SIDES; turn++) {
+            for (Direction dir = NORTH; dir <= WEST; dir++) {
+                layout.turns[id * NUM_SIDES + turn][dir] = tile.getEdgeId(dir);
+            }
+            tile.rotate();
+        }
+        layout.blankTile[id] = tiles[id].isBlank();
+    }
+    for (int label = 0; label < MAX_LABELS; label++) {
+        layout.complement[label] = puzzle.complementOf(label);
+    }
+}
+
+// adds the tiles of an assignment to the empty cells of board
+static void fillBoard(const AnnealLayout& layout, const Vector<Tile>& tiles, const vector<int>& tileAt,
+                      const vector<uint8_t>& turnAt, Puzzle& board) {
+    for (int slot = 0; slot < layout.freeCells.size(); slot++) {
+        Tile tile = tiles[tileAt[slot]];
+        for (int turn = 0; turn < turnAt[slot]; turn++) tile.rotate();
+        int cell = layout.freeCells[slot];
+        board.add(tile, GridLocation(cell / layout.numCols, cell % layout.numCols));
+    }
+}
+
+AnnealResult anneal(Puzzle& puzzle, Vector<Tile>& tiles, const AnnealOptions& options) {
+    auto start = chrono::steady_clock::now();
+    auto elapsedMs = [&]() { return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count(); };
+    AnnealLayout layout;
+    buildLayout(puzzle, tiles, layout);
+    AnnealResult result;
+    result.totalEdges = puzzle.numRows() * (puzzle.numCols() - 1) + puzzle.numCols() * (puzzle.numRows() - 1);
+
+    // temperatures rise geometrically with the index into order, which names the replica holding each
+    int numReplicas = max(1, options.replicas);
+    vector<Replica> replicas(numReplicas);
+    vector<int> order(numReplicas);
+    for (int k = 0; k < numReplicas; k++) {
+        Replica& replica = replicas[k];
+        replica.rng.seed(options.seed + k);
+        replica.edges = layout.edges;
+        replica.blank = layout.blank;
+        replica.tileAt.resize(layout.numSlots);
+        replica.turnAt.resize(layout.numSlots);
+        vector<int> ids(layout.numSlots);
+        for (int id = 0; id < layout.numSlots; id++) ids[id] = id;
+        shuffle(ids.begin(), ids.end(), replica.rng);
+        for (int slot = 0; slot < layout.numSlots; slot++) {
+            place(layout, replica, slot, ids[slot], uniform_int_distribution<int>(0, NUM_SIDES - 1)(replica.rng));
+        }
+        replica.score = scoreBoard(layout, replica);
+        keepBest(replica);
+        double step = (numReplicas > 1) ? double(k) / (numReplicas - 1) : 0;
+        replica.temperature = options.minTemperature * pow(options.maxTemperature / options.minTemperature, step);
+        order[k] = k;
+    }
+
+    int best = 0;  // replica whose best board is the best seen so far
+    for (int k = 1; k < numReplicas; k++) {
+        if (replicas[k].bestScore > replicas[best].bestScore) best = k;
+    }
+    vector<int> bestTileAt = replicas[best].bestTileAt;
+    vector<uint8_t> bestTurnAt = replicas[best].bestTurnAt;
+    result.matched = replicas[best].bestScore;
+
+    auto deadline = start + chrono::duration_cast<chrono::steady_clock::duration>(
+                                chrono::duration<double, milli>(options.timeLimitMs));
+    WorkStealingPool pool(options.threads);
+    Puzzle board = puzzle;
+    mt19937 exchangeRng(options.seed);
+    uniform_real_distribution<double> unit(0, 1);
+    bool reported = false;
+    for (int parity = 0; !layout.freeCells.isEmpty(); parity ^= 1) {
+        auto epochEnd = min(deadline, chrono::steady_clock::now() + chrono::duration_cast<chrono::steady_clock::duration>(
+                                                                        chrono::duration<double, milli>(kEpochMs)));
+        for (Replica& replica : replicas) {
+            pool.submit([&layout, &replica, &result, epochEnd, &options]() {
+                runReplica(layout, replica, result.totalEdges, epochEnd, options.cancel);
+            });
+        }
+        pool.wait();
+
+        result.moves = 0;
+        bool improved = !reported;
+        for (const Replica& replica : replicas) {
+            result.moves += replica.moves;
+            if (replica.bestScore > result.matched) {
+                result.matched = replica.bestScore;
+                bestTileAt = replica.bestTileAt;
+                bestTurnAt = replica.bestTurnAt;
+                improved = true;
+            }
+        }
+        if (improved && options.observer) {
+            result.elapsedMs = elapsedMs();
+            board.cloneFrom(puzzle);
+            fillBoard(layout, tiles, bestTileAt, bestTurnAt, board);
+            options.observer(board, result);
+            reported = true;
+        }
+        if (result.matched == result.totalEdges || chrono::steady_clock::now() >= deadline) break;
+        if (options.cancel && options.cancel->load(memory_order_relaxed)) break;
+
+        // alternate between exchanging pairs (0,1), (2,3), ... and (1,2), (3,4), ...
+        for (int k = parity; k + 1 < numReplicas; k += 2) {
+            Replica& colder = replicas[order[k]];
+            Replica& hotter = replicas[order[k + 1]];
+            double betaGap = 1 / colder.temperature - 1 / hotter.temperature;
+            // energy is unmatched edges, so this favors moving the better board to the colder temperature
+            if (unit(exchangeRng) < exp(betaGap * (hotter.score - colder.score))) {
+                swap(colder.temperature, hotter.temperature);
+                swap(order[k], order[k + 1]);
+                result.exchanges++;
+            }
+        }
+    }
+
+    fillBoard(layout, tiles, bestTileAt, bestTurnAt, puzzle);
+    Vector<Tile> spares;
+    for (int slot = layout.freeCells.size(); slot < layout.numSlots; slot++) {
+        spares.add(tiles[bestTileAt[slot]]);
+    }
+    tiles = spares;
+    result.elapsedMs = elapsedMs();
+    return result;
+}
+
+
+/* * * * * * Test Cases * * * * * */
+
+STUDENT_TEST("anneal fills a small solvable puzzle with every edge matched and keeps placed tiles") {
+    for (string file : { "puzzles/turtles/turtles.txt", "puzzles/cola/cola_smaller.txt", "puzzles/cola/cola.txt" }) {
+        Puzzle puzzle;
+        Vector<Tile> tiles;
+        string reason;
+        if (!loadPuzzleFile(file, puzzle, tiles, reason)) error(file + ": " + reason);
+        int numTiles = tiles.size();
+        // pin the corner a solution has, so the rest can still be matched around it
+        Puzzle solved = puzzle;
+        Vector<Tile> unused = tiles;
+        EXPECT(solve(solved, unused, SolveOptions()));
+        GridLocation pinned(0, 0);
+        Tile corner = solved.tileAt(pinned);
+        puzzle.add(corner, pinned);
+        for (int i = 0; i < tiles.size(); i++) {
+            if (tiles[i] == corner) {
+                tiles.remove(i);
+                break;
+            }
+        }
+
+        AnnealOptions options;
+        options.timeLimitMs = 10000;
+        options.threads = 2;
+        long improvements = 0;
+        options.observer = [&](const Puzzle& board, const AnnealResult&) {
+            EXPECT(board.isFull());
+            improvements++;
+        };
+        AnnealResult result = anneal(puzzle, tiles, options);
+
+        EXPECT_EQUAL(result.matched, result.totalEdges);
+        EXPECT(result.elapsedMs < options.timeLimitMs);
+        EXPECT(improvements > 0);
+        EXPECT(puzzle.isFull());
+        EXPECT_EQUAL(puzzle.numFilled(), numTiles);
+        EXPECT(tiles.isEmpty());
+        EXPECT_EQUAL(puzzle.tileAt(pinned), corner);
+        for (int row = 0; row < puzzle.numRows(); row++) {
+            for (int col = 0; col < puzzle.numCols(); col++) {
+                GridLocation loc(row, col);
+                for (Direction dir = NORTH; dir <= WEST; dir++) {
+                    EXPECT(puzzle.canMatchEdge(puzzle.tileAt(loc), loc, dir));
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include "Puzzle.h"
+#include "Tile.h"
+#include "vector.h"
+
+/**
+ * AnnealResult
+ * ------------
+ * How far anneal got. matched counts the interior edges of the best board
+ * whose two sides match by the rules of Puzzle::canMatchEdge, out of
+ * totalEdges; the board is a solution when they are equal. moves counts the
+ * rotations and swaps tried by all replicas, exchanges the accepted swaps of
+ * temperature between replicas.
+ */
+struct AnnealResult {
+    int matched = 0;
+    int totalEdges = 0;
+    long moves = 0;
+    long exchanges = 0;
+    double elapsedMs = 0;
+};
+
+/**
+ * AnnealObserver
+ * --------------
+ * Called by anneal on the calling thread each time the best board improves,
+ * with that board (every empty cell filled) and the counts so far.
+ */
+typedef std::function<void(const Puzzle&, const AnnealResult&)> AnnealObserver;
+
+/**
+ * AnnealOptions
+ * -------------
+ * timeLimitMs bounds the run; anneal stops sooner once every edge matches or
+ * cancel is set. replicas is the number of boards annealed side by side at
+ * fixed temperatures spaced geometrically from minTemperature to
+ * maxTemperature, run on threads workers (0 for one per hardware thread).
+ * seed starts the random moves of the replicas; the replicas are exchanged
+ * at timed intervals, so two runs with the same seed can still differ.
+ */
+struct AnnealOptions {
+    double timeLimitMs = 1000;
+    int replicas = 8;
+    int threads = 0;
+    unsigned seed = 1;
+    double minTemperature = 0.05;
+    double maxTemperature = 1.0;
+    AnnealObserver observer;
+    const std::atomic<bool>* cancel = nullptr;
+};
+
+/**
+ * anneal
+ * ------
+ * Anytime alternative to solve() for puzzles with no solution, or too big to
+ * search exhaustively: fills the empty cells of puzzle so as to match as many
+ * interior edges as it can. Each replica starts from a random board and makes
+ * random moves, either turning one tile or swapping two (a tile not on the
+ * board can be swapped in when there are more tiles than empty cells). Only
+ * the edges around the moved tiles are rescored. A move that loses d matched
+ * edges is kept with probability exp(-d / T) at the replica's temperature T.
+ * Every few milliseconds the replicas stop and neighbouring temperatures are
+ * exchanged (parallel tempering), so good boards found while hot get cooled.
+ *
+ * Tiles already on the board stay where they are. There must be at least as
+ * many tiles as empty cells. On return the board holds the best arrangement
+ * found, whether or not it is a solution, and tiles holds the tiles left over.
+ */
+AnnealResult anneal(Puzzle& puzzle, Vector<Tile>& tiles, const AnnealOptions& options);
@@ -0,0 +1,129 @@
+/*
+ * File: NogoodTable.cpp
+ * ---------------------
+ * Fixed-size set-associative table of failed search positions, see
+ * NogoodTable.h.
+ */
+#include "NogoodTable.h"
+#include "PuzzleConfig.h"
+#include "SimpleTest.h"
+#include <algorithm>
+#include <climits>
+
+using namespace std;
+
+static uint64_t mix(uint64_t value) {
+    value ^= value >> 33;
+    value *= 0xff51afd7ed558ccdULL;
+    value ^= value >> 33;
+    value *= 0xc4ceb9fe1a85ec53ULL;
+    return value ^ (value >> 33);
+}
+
+NogoodTable::NogoodTable(long budgetKb, int numCols) : _frontier(numCols + 1), _stride(numCols + 1) {
+    long fit = budgetKb * 1024 / long((sizeof(Entry) + _stride) * kWays);
+    uint64_t buckets = 1;
+    while (long(buckets * 2) <= fit) buckets *= 2;
+    _entries = Vector<Entry>(buckets * kWays, Entry());
+    _labels.assign(buckets * kWays * _stride, BLANK_LABEL);
+    _mask = buckets - 1;
+}
+
+// copies the frontier of the row-major filled puzzle into _frontier and returns its hash
+uint64_t NogoodTable::readFrontier(const Puzzle& puzzle) {
+    int cols = puzzle.numCols();
+    int row = puzzle.numFilled() / cols, col = puzzle.numFilled() % cols;
+    uint64_t hash = mix(puzzle.numFilled());
+    for (int c = 0; c < cols; c++) {
+        int above = (c < col) ? row : row - 1;  // lowest filled cell of column c
+        _frontier[c] = (above >= 0) ? puzzle.tileAt(GridLocation(above, c)).getEdgeId(SOUTH) : BLANK_LABEL;
+        hash = mix(hash ^ _frontier[c]);
+    }
+    _frontier[cols] = (col > 0) ? puzzle.tileAt(GridLocation(row, col - 1)).getEdgeId(EAST) : BLANK_LABEL;
+    return mix(hash ^ _frontier[cols]);
+}
+
+// the slot in bucket holding exactly this position, or -1
+int NogoodTable::find(uint64_t bucket, const TileBitset& remaining, uint64_t hash, int filled) const {
+    for (int i = 0; i < kWays; i++) {
+        int slot = bucket * kWays + i;
+        const Entry& entry = _entries[slot];
+        if (entry.work && entry.hash == hash && entry.filled == filled && entry.remaining == remaining
+            && equal(_frontier.begin(), _frontier.end(), _labels.begin() + slot * _stride)) {
+            return slot;
+        }
+    }
+    return -1;
+}
+
+// the bucket comes from the frontier hash and the tiles left
+static uint64_t bucketHash(uint64_t hash, const TileBitset& remaining) {
+    for (int w = 0; w < TileBitset::kNumWords; w++) {
+        hash = mix(hash ^ remaining.word(w));
+    }
+    return hash;
+}
+
+bool NogoodTable::contains(const Puzzle& puzzle, const TileBitset& remaining) {
+    _stats.lookups++;
+    uint64_t hash = bucketHash(readFrontier(puzzle), remaining);
+    if (find(hash & _mask, remaining, hash, puzzle.numFilled()) < 0) return false;
+    _stats.hits++;
+    return true;
+}
+
+void NogoodTable::record(const Puzzle& puzzle, const TileBitset& remaining, long work) {
+    uint32_t cost = uint32_t(min(max(work, 1L), long(UINT32_MAX)));
+    uint64_t hash = bucketHash(readFrontier(puzzle), remaining);
+    uint64_t bucket = hash & _mask;
+    int known = find(bucket, remaining, hash, puzzle.numFilled());
+    if (known >= 0) {
+        _entries[known].work = max(_entries[known].work, cost);
+        return;
+    }
+    int victim = bucket * kWays;
+    for (int i = 1; i < kWays; i++) {
+        if (_entries[bucket * kWays + i].work < _entries[victim].work) victim = bucket * kWays + i;
+    }
+    Entry& entry = _entries[victim];
+    if (entry.work) _stats.evictions++;
+    _stats.stores++;
+    entry.remaining = remaining;
+    entry.hash = hash;
+    entry.filled = puzzle.numFilled();
+    entry.work = cost;
+    copy(_frontier.begin(), _frontier.end(), _labels.begin() + victim * _stride);
+}
+
+/* * * * * * Test Cases * * * * * */
+
+STUDENT_TEST("a dead end is found again only with the same frontier labels and tiles left") {
+    Puzzle puzzle;
+    Vector<Tile> tiles;
+    string reason;
+    EXPECT(loadPuzzleFile("puzzles/cola/cola.txt", puzzle, tiles, reason));
+    NogoodTable table(0, puzzle.numCols());  // a single bucket, so every position is compared in full
+    TileBitset remaining;
+    for (int id = 1; id < tiles.size(); id++) {
+        remaining.add(id);
+    }
+    Puzzle board = puzzle;
+    board.add(tiles[0]);
+    table.record(board, remaining, 10);
+    EXPECT(table.contains(board, remaining));
+
+    // the same tile turned a quarter leaves other labels facing the cells still to fill
+    Puzzle turned = puzzle;
+    Tile tile = tiles[0];
+    tile.rotate();
+    turned.add(tile);
+    EXPECT(!table.contains(turned, remaining));
+
+    // the same frontier with another tile left over is another position
+    TileBitset other = remaining;
+    other.remove(1);
+    other.add(0);
+    EXPECT(!table.contains(board, other));
+    EXPECT_EQUAL(table.stats().hits, 1);
+    EXPECT_EQUAL(table.stats().lookups, 3);
+}
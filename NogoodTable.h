@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "Puzzle.h"
+#include "TileBitset.h"
+#include "vector.h"
+
+/**
+ * NogoodTable
+ * -----------
+ * Transposition table of dead ends for the row-major searches. Once the
+ * first k cells are filled, the rest of the search depends only on which
+ * tiles remain and on the frontier: the south labels along the bottom of the
+ * filled cells plus the east label of the last one. When every candidate from
+ * such a position has failed, the position is recorded, and reaching it again
+ * through another prefix fails at once.
+ *
+ * An entry keeps the remaining-tile set, the number of cells filled and the
+ * frontier labels exactly, so a hit is always the same position; a hash of
+ * them only picks the bucket. The table is fixed in size by its memory budget and
+ * organised in buckets of kWays entries; a full bucket evicts the entry whose
+ * failed subtree took the fewest placements to explore, keeping the dead ends
+ * that are most expensive to rediscover.
+ */
+class NogoodTable {
+public:
+    static const int kWays = 4;
+
+    struct Stats {
+        long lookups = 0;
+        long hits = 0;
+        long stores = 0;
+        long evictions = 0;
+
+        Stats& operator+=(const Stats& other) {
+            lookups += other.lookups;
+            hits += other.hits;
+            stores += other.stores;
+            evictions += other.evictions;
+            return *this;
+        }
+    };
+
+    /**
+     * @brief NogoodTable allocates as many buckets as fit in budgetKb, at least
+     *        one, for boards numCols wide
+     */
+    NogoodTable(long budgetKb, int numCols);
+
+    /**
+     * @brief contains: was the position of puzzle, filled in row-major order,
+     *        with these tiles left recorded as a dead end?
+     */
+    bool contains(const Puzzle& puzzle, const TileBitset& remaining);
+
+    /**
+     * @brief record stores the position of puzzle with these tiles left as a dead end
+     * @param work: placements it took to find out, used to choose what to evict
+     */
+    void record(const Puzzle& puzzle, const TileBitset& remaining, long work);
+
+    const Stats& stats() const { return _stats; }
+
+private:
+    struct Entry {
+        TileBitset remaining;
+        uint64_t hash = 0;  // of the whole position, compared first
+        int filled = 0;
+        uint32_t work = 0;  // 0 marks an empty slot
+    };
+
+    uint64_t readFrontier(const Puzzle& puzzle);
+    int find(uint64_t bucket, const TileBitset& remaining, uint64_t hash, int filled) const;
+
+    Vector<Entry> _entries;
+    std::vector<LabelId> _labels;    // the frontier of each entry, _stride labels apiece
+    std::vector<LabelId> _frontier;  // the frontier of the board being looked up
+    int _stride;     // numCols south labels plus the west label
+    uint64_t _mask;  // number of buckets - 1, a power of two
+    Stats _stats;
+};
@@ -9,7 +9,7 @@
  * and validate tile placement according to the rules of the puzzle.
  */
 #include "Puzzle.h"
-#include "PuzzleGUI.h"
+#include "SolveProfile.h"
 #include "SimpleTest.h"
 
 using namespace std;
@@ -27,37 +27,61 @@ bool Puzzle::canMatchEdge(Tile tile, GridLocation loc, Direction dir) const {
     if (dir == NORTH)
     {
         GridLocation other(loc.row - 1, loc.col);
-        return other.row == -1 || tileAt(other).isBlank() || isComplement(tile.getEdge(NORTH), tileAt(other).getEdge(SOUTH));
+        return other.row == -1 || tileAt(other).isBlank() || isComplement(tile.getEdgeId(NORTH), tileAt(other).getEdgeId(SOUTH));
     }
     else if (dir == EAST)
     {
         GridLocation other(loc.row, loc.col + 1);
-        return other.col == _grid.numCols() || tileAt(other).isBlank() || isComplement(tile.getEdge(EAST), tileAt(other).getEdge(WEST));
+        return other.col == _numCols || tileAt(other).isBlank() || isComplement(tile.getEdgeId(EAST), tileAt(other).getEdgeId(WEST));
     }
     else if (dir == SOUTH)
     {
         GridLocation other(loc.row + 1, loc.col);
-        return other.row == _grid.numRows() || tileAt(other).isBlank() || isComplement(tile.getEdge(SOUTH), tileAt(other).getEdge(NORTH));
+        return other.row == _numRows || tileAt(other).isBlank() || isComplement(tile.getEdgeId(SOUTH), tileAt(other).getEdgeId(NORTH));
     }
     else
     {
         GridLocation other(loc.row, loc.col - 1);
-        return other.col == -1 || tileAt(other).isBlank() || isComplement(tile.getEdge(WEST), tileAt(other).getEdge(EAST));
+        return other.col == -1 || tileAt(other).isBlank() || isComplement(tile.getEdgeId(WEST), tileAt(other).getEdgeId(EAST));
     }
 }
 
-/* Feel free to investigate the functions below, but you should not modify them */
+/* Board bookkeeping: the complement table, the cells and the stack of placements.
+ * The solver engines depend on add and remove keeping _numInOrder and _placed
+ * in step with the grid, so change them together. */
 
 // configures the puzzle with data read from the puzzle configuration file
 void Puzzle::configure(int numRows, int numCols, Map<string, string>& pairs) {
-    _complementMap = pairs;
-    _grid.resize(numRows, numCols);
-    _grid.clear();
+    for (int i = 0; i < MAX_LABELS; i++) {
+        _complement[i] = BLANK_LABEL;
+    }
+    for (const string& label : pairs) {
+        _complement[Tile::internLabel(label)] = Tile::internLabel(pairs[label]);
+    }
+    _labelTableId = Tile::labelTableId();
+    reset(numRows, numCols);
+}
+
+void Puzzle::configure(int numRows, int numCols, const LabelId complement[MAX_LABELS]) {
+    for (int i = 0; i < MAX_LABELS; i++) {
+        _complement[i] = complement[i];
+    }
+    _labelTableId = Tile::labelTableId();
+    reset(numRows, numCols);
+}
+
+void Puzzle::reset(int numRows, int numCols) {
+    if (numRows < 0 || numCols < 0) error("Puzzle dimensions cannot be negative!");
+    _numRows = numRows;
+    _numCols = numCols;
+    _cells.assign(numRows * numCols, Tile());
+    _placed.assign(numRows * numCols, 0);
     _numFilled = 0;
+    _numInOrder = 0;
 }
 
 bool Puzzle::isFull() const {
-    return _numFilled == _grid.size();
+    return _numFilled == int(_cells.size());
 }
 
 bool Puzzle::isEmpty() const {
@@ -65,44 +89,72 @@ bool Puzzle::isEmpty() const {
 }
 
 bool Puzzle::canAdd(Tile tile) const {
-    return !isFull() && canMatchAllEdges(tile, locationForCount(_numFilled));
+    return !isFull() && canMatchAllEdges(tile, nextLocation());
+}
+
+bool Puzzle::canAdd(Tile tile, GridLocation loc) const {
+    return inBounds(loc) && tileAt(loc).isBlank() && canMatchAllEdges(tile, loc);
 }
 
 void Puzzle::add(Tile tile) {
     if (isFull()) error("Cannot add to full grid!");
-    GridLocation where = locationForCount(_numFilled);
-    _grid[where] = tile;
+    add(tile, nextLocation());
+}
+
+void Puzzle::add(Tile tile, GridLocation loc) {
+    if (!inBounds(loc) || !tileAt(loc).isBlank()) error("Cannot add to filled or out of bounds location " + loc.toString() + "!");
+    PROFILE_ADD(_numFilled);
+    int count = countForLocation(loc);
+    _cells[count] = tile;
+    _placed[_numFilled] = count;
     _numFilled++;
+    // extend the filled run past loc and any cells that were filled out of order beyond it
+    while (_numInOrder < int(_cells.size()) && !_cells[_numInOrder].isBlank()) {
+        _numInOrder++;
+    }
 }
 
 Tile Puzzle::remove() {
     if (isEmpty()) error("Cannot remove from empty grid!");
-    GridLocation where = locationForCount(_numFilled - 1);
-    Tile removed = _grid[where];
-    _grid[where] = Tile(); // replace with blank tile
+    return remove(lastPlaced());
+}
+
+Tile Puzzle::remove(GridLocation loc) {
+    if (!inBounds(loc) || tileAt(loc).isBlank()) error("Cannot remove from empty location " + loc.toString() + "!");
+    int count = countForLocation(loc);
+    Tile removed = _cells[count];
+    _cells[count] = Tile(); // replace with blank tile
+    int i = _numFilled - 1;
+    while (_placed[i] != count) i--; // almost always the last entry
+    for (; i < _numFilled - 1; i++) {
+        _placed[i] = _placed[i + 1];
+    }
     _numFilled--;
+    PROFILE_REMOVE(_numFilled);
+    if (count < _numInOrder) _numInOrder = count;
     return removed;
 }
 
+GridLocation Puzzle::lastPlaced() const {
+    if (isEmpty()) error("No tile has been placed!");
+    return locationForCount(_placed[_numFilled - 1]);
+}
+
 // this is a little translation function to turn a 1-dimensional
 // count into a 2-dimensional grid location
 GridLocation Puzzle::locationForCount(int count) const {
     GridLocation loc;
-    loc.row = count / _grid.numCols();
-    loc.col = count % _grid.numCols();
+    loc.row = count / _numCols;
+    loc.col = count % _numCols;
     return loc;
 }
 
-// This is how we determine if two edges match (e.g., a red bottle top and a red bottle bottom)
-// The map is populated with matching edge pairs read from the puzzle configuration file
-bool Puzzle::isComplement(string one, string two) const {
-    return _complementMap[one] == two;
-}
-
 //  verify each of the four edges of the tile matches its adjacent neighbor
 bool Puzzle::canMatchAllEdges(Tile tile, GridLocation loc) const {
     for (Direction dir = NORTH; dir <= WEST; dir++) {
-        if (!canMatchEdge(tile, loc, dir)) {
+        bool matched = canMatchEdge(tile, loc, dir);
+        PROFILE_EDGE(_numFilled, dir, matched);
+        if (!matched) {
             return false;
         }
     }
@@ -111,16 +163,98 @@ bool Puzzle::canMatchAllEdges(Tile tile, GridLocation loc) const {
 
 // access the tile at the given grid location
 Tile Puzzle::tileAt(GridLocation loc) const {
-    return _grid[loc];
+    if (!inBounds(loc)) error("Location " + loc.toString() + " is out of bounds!");
+    return _cells[countForLocation(loc)];
+}
+
+void Puzzle::cloneFrom(const Puzzle& other) {
+    if (other.numRows() != numRows() || other.numCols() != numCols()) error("Cannot clone a board of another size!");
+    memcpy(_cells.data(), other._cells.data(), _cells.size() * sizeof(Tile));
+    memcpy(_placed.data(), other._placed.data(), other._numFilled * sizeof(int));
+    _numFilled = other._numFilled;
+    _numInOrder = other._numInOrder;
 }
 
 // basic 2d traversal of the grid. Assumes the tile can print itself, as well
 void Puzzle::print() const {
     GridLocation cur;
-    for (cur.row = 0; cur.row < _grid.numRows(); cur.row++) {
-        for (cur.col = 0; cur.col < _grid.numCols(); cur.col++) {
+    for (cur.row = 0; cur.row < _numRows; cur.row++) {
+        for (cur.col = 0; cur.col < _numCols; cur.col++) {
             cout << tileAt(cur) << "  ";
         }
         cout << endl;
     }
 }
+
+/* * * * * * Test Cases * * * * * */
+
+// every cell, rotation and the placement order must come back as they were
+static bool sameBoard(const Puzzle& one, const Puzzle& two) {
+    if (one.numFilled() != two.numFilled() || one.isFilledInOrder() != two.isFilledInOrder()) return false;
+    if (!one.isEmpty() && (one.lastPlaced() != two.lastPlaced() || one.nextLocation() != two.nextLocation())) return false;
+    for (int row = 0; row < one.numRows(); row++) {
+        for (int col = 0; col < one.numCols(); col++) {
+            Tile a = one.tileAt({ row, col }), b = two.tileAt({ row, col });
+            if (!(a == b) || a.getRotation() != b.getRotation()) return false;
+        }
+    }
+    return true;
+}
+
+STUDENT_TEST("restore gives back the board snapshot was taken from") {
+    LabelId complement[MAX_LABELS] = {};
+    complement[1] = 2;
+    complement[2] = 1;
+    Puzzle puzzle, copy;
+    puzzle.configure(3, 3, complement);
+    copy.configure(3, 3, complement);
+    BoardState state;
+
+    puzzle.snapshot(state);
+    copy.restore(state);
+    EXPECT(sameBoard(puzzle, copy));
+
+    Tile tile(1, 2, 1, 2);
+    tile.rotate();
+    puzzle.add(tile);
+    puzzle.add(Tile(2, 1, 2, 1), { 2, 2 });
+    puzzle.add(Tile(1, 1, 2, 2), { 1, 0 });
+    puzzle.remove({ 2, 2 });
+    puzzle.snapshot(state);
+    copy.restore(state);
+    EXPECT(sameBoard(puzzle, copy));
+    EXPECT_EQUAL(copy.remove(), Tile(1, 1, 2, 2));
+    EXPECT_EQUAL(copy.remove().getRotation(), 1);
+    EXPECT(copy.isEmpty());
+}
+
+STUDENT_TEST("snapshot refuses a board bigger than the state") {
+    LabelId complement[MAX_LABELS] = {};
+    Puzzle puzzle;
+    puzzle.configure(9, 9, complement);
+    BoardState state;
+    EXPECT_ERROR(puzzle.snapshot(state));
+    LargeBoardState large;
+    EXPECT_NO_ERROR(puzzle.snapshot(large));
+}
+
+STUDENT_TEST("cloneFrom copies the board and the order tiles were placed in") {
+    LabelId complement[MAX_LABELS] = {};
+    complement[1] = 2;
+    complement[2] = 1;
+    Puzzle puzzle, copy;
+    puzzle.configure(2, 3, complement);
+    copy.configure(2, 3, complement);
+    copy.add(Tile(2, 2, 2, 2), { 1, 2 });
+
+    puzzle.add(Tile(1, 2, 1, 2));
+    puzzle.add(Tile(2, 1, 2, 1), { 1, 1 });
+    puzzle.add(Tile(1, 1, 2, 2), { 0, 2 });
+    puzzle.remove({ 1, 1 });  // out of placement order
+    copy.cloneFrom(puzzle);
+    EXPECT(sameBoard(puzzle, copy));
+    EXPECT_EQUAL(copy.remove(), Tile(1, 1, 2, 2));
+    EXPECT_EQUAL(copy.remove(), Tile(1, 2, 1, 2));
+    EXPECT(copy.isEmpty());
+    EXPECT(copy.tileAt({ 1, 2 }).isBlank());
+}
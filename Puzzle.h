@@ -1,9 +1,14 @@
 #pragma once
 
+#include <cstring>
+#include <vector>
+#include "BoardState.h"
 #include "Tile.h"
 #include "direction.h"
-#include "grid.h"
+#include "error.h"
+#include "gridlocation.h"
 #include "map.h"
+#include "vector.h"
 
 class Puzzle {
 public:
@@ -22,10 +27,18 @@ public:
      *        and clears the puzzle
      * @param numRows: the number of rows in the puzzle (usually 3)
      * @param numCols: the number of columns in the puzzle (usually 3)
-     * @param pairs:
+     * @param pairs: the label=opposite pairs, mapped in both directions. Labels are
+     *        interned and stored as a flat complement table indexed by label id
      */
     void configure(int numRows, int numCols, Map<std::string, std::string>& pairs);
 
+    /**
+     * @brief configure (overloaded) takes the complement table directly, indexed by
+     *        label id, as read back from a compiled puzzle
+     * @param complement: MAX_LABELS entries, BLANK_LABEL for labels without a pair
+     */
+    void configure(int numRows, int numCols, const LabelId complement[MAX_LABELS]);
+
     /**
      * @brief isFull: is the grid full?
      * @return true if all grid locations are filled, false otherwise
@@ -47,19 +60,54 @@ public:
     bool canAdd(Tile tile) const;
 
     /**
-     * @brief add adds tile to the grid at the next unfilled location. Grid locations are
-     *        filled left to right and then top to bottom. Validity of the match is not
+     * @brief canAdd: is it valid to add tile to the grid at loc? valid means loc is
+     *        an empty cell on the board and all edges of the tile match there
+     * @param tile: a Tile
+     * @param loc: the cell to place it in
+     */
+    bool canAdd(Tile tile, GridLocation loc) const;
+
+    /**
+     * @brief add adds tile to the grid at the next unfilled location, which is the first
+     *        empty cell left to right and then top to bottom. Validity of the match is not
      *        checked by add, call canAdd to confirm before add
      * @param tile: a Tile
      */
     void add(Tile tile);
 
     /**
-     * @brief remove removes the last tile added (i.e. at the last filled location)
+     * @brief add adds tile to the grid at loc, which must be an empty cell. Locations
+     *        may be filled in any order; each one is pushed on the stack of placements
+     * @param tile: a Tile
+     * @param loc: the cell to place it in
+     */
+    void add(Tile tile, GridLocation loc);
+
+    /**
+     * @brief remove removes the last tile added, wherever it was placed
      * @return the tile that was removed is returned
      */
     Tile remove();
 
+    /**
+     * @brief remove removes the tile at loc, which must be filled, and drops loc from
+     *        the stack of placements
+     * @return the tile that was removed is returned
+     */
+    Tile remove(GridLocation loc);
+
+    /**
+     * @brief lastPlaced returns the location of the most recent placement still on the board
+     */
+    GridLocation lastPlaced() const;
+
+    /**
+     * @brief isFilledInOrder: are the filled cells exactly the first numFilled cells in
+     *        row-major order? Then the north and west neighbors are the only filled
+     *        neighbors of nextLocation
+     */
+    bool isFilledInOrder() const { return _numInOrder == _numFilled; }
+
     /**
      * @brief tileAt returns the tile at the grid location loc
      * @param loc: a GridLocation to pull the tile from
@@ -67,6 +115,64 @@ public:
      */
     Tile tileAt(GridLocation loc) const;
 
+    /**
+     * @brief nextLocation returns the grid location the next add will fill
+     */
+    GridLocation nextLocation() const { return locationForCount(_numInOrder); }
+
+    /**
+     * @brief neighbor finds the cell next to loc in direction dir
+     * @param other: set to that cell, even when it is off the board
+     * @return true if other is on the board
+     */
+    bool neighbor(GridLocation loc, Direction dir, GridLocation& other) const {
+        other = GridLocation(loc.row + (dir == SOUTH) - (dir == NORTH), loc.col + (dir == EAST) - (dir == WEST));
+        return inBounds(other);
+    }
+
+    /**
+     * @brief complementOf returns the label that matches label across an edge,
+     *        BLANK_LABEL if label has no entry in the pairs
+     */
+    LabelId complementOf(LabelId label) const { return _complement[label]; }
+
+    /**
+     * @brief hasCurrentLabels: were the labels of this puzzle interned into the
+     *        current label table? If not, getEdge and labelString give strings
+     *        from another puzzle for its ids (see LabelScope)
+     */
+    bool hasCurrentLabels() const { return _labelTableId == Tile::labelTableId(); }
+
+    int numRows() const { return _numRows; }
+    int numCols() const { return _numCols; }
+    int numFilled() const { return _numFilled; }
+
+    /**
+     * @brief snapshot copies the tiles on the board and the order they were placed
+     *        in into state. The board must fit, see BoardStateOf::fits
+     * @param state: overwritten with the board
+     */
+    template <int MaxCells>
+    void snapshot(BoardStateOf<MaxCells>& state) const;
+
+    /**
+     * @brief restore puts the board back as it was when state was taken. The puzzle
+     *        must have the size state was taken from; the complement table is kept,
+     *        so state should come from this puzzle or one configured the same way
+     * @param state: a board from snapshot
+     */
+    template <int MaxCells>
+    void restore(const BoardStateOf<MaxCells>& state);
+
+    /**
+     * @brief cloneFrom makes this board a copy of the board of other, which must
+     *        have the same size and complement table. Unlike assignment it copies
+     *        only the cells and placements into the storage this puzzle already
+     *        has, so copying into a scratch puzzle allocates nothing
+     * @param other: the puzzle to copy the board from
+     */
+    void cloneFrom(const Puzzle& other);
+
     /**
      * @brief print prints out the puzzle in a human-readable form (useful for debugging)
      */
@@ -74,13 +180,13 @@ public:
 
 private:
     /**
-     * @brief isComplement returns true if the strings are complements of each other
-     *        in the complement map. Ordering of one and two is irrelevant
-     * @param one: one potential string for matching
+     * @brief isComplement returns true if the labels are complements of each other
+     *        in the complement table. Ordering of one and two is irrelevant
+     * @param one: one potential label id for matching
      * @param two: the second potential match
      * @return true if they match, false otherwise
      */
-    bool isComplement(std::string one, std::string two) const;
+    bool isComplement(LabelId one, LabelId two) const { return _complement[one] == two; }
 
     /**
      * @brief matchesAt ensures that tile matches on all sides if it was placed at loc
@@ -90,6 +196,11 @@ private:
      */
     bool canMatchAllEdges(Tile tile, GridLocation loc) const;
 
+    /**
+     * @brief reset sizes the grid and empties it, used by both configure overloads
+     */
+    void reset(int numRows, int numCols);
+
     /**
      * @brief locationForCount translates a count (0-8 for a 3x3 puzzle) into a grid location
      * @param count: 0 to (numRows * numCols) - 1
@@ -98,18 +209,73 @@ private:
     GridLocation locationForCount(int count) const;
 
     /**
-     * @brief _grid is the underlying grid that holds all of the tiles in the puzzle
+     * @brief countForLocation is the inverse of locationForCount, the row-major index of loc
      */
-    Grid<Tile> _grid;
+    int countForLocation(GridLocation loc) const { return loc.row * _numCols + loc.col; }
+
+    bool inBounds(GridLocation loc) const {
+        return loc.row >= 0 && loc.row < _numRows && loc.col >= 0 && loc.col < _numCols;
+    }
+
+    int _numRows = 0;
+    int _numCols = 0;
+
+    /**
+     * @brief _cells holds the tiles of the puzzle in row-major order, blank for an
+     *        empty cell. It is flat so that a BoardState is copied in and out whole
+     */
+    std::vector<Tile> _cells;
 
     /**
-     * @brief _complementMap is a map of matching tile edge strings. It is bidirectional,
-     *        so that it maps A->a and a->A for each pair of strings
+     * @brief _complement is a flat table of matching label ids, indexed by label id.
+     *        It is bidirectional, so that it maps A->a and a->A for each pair of labels.
+     *        Labels without a pair map to BLANK_LABEL
      */
-    Map<std::string, std::string> _complementMap;
+    LabelId _complement[MAX_LABELS];
+
+    /**
+     * @brief _labelTableId is Tile::labelTableId() when the puzzle was configured
+     */
+    long _labelTableId = 0;
 
     /**
      * @brief _numFilled is the number of filled locations in the grid
      */
-    int _numFilled;
+    int _numFilled = 0;
+
+    /**
+     * @brief _numInOrder is the length of the run of filled cells at the start of the
+     *        grid in row-major order, so locationForCount(_numInOrder) is the first empty cell
+     */
+    int _numInOrder = 0;
+
+    /**
+     * @brief _placed is the stack of filled cells as row-major indices, most recent
+     *        last. Only the first _numFilled entries are in use
+     */
+    std::vector<int> _placed;
 };
+
+template <int MaxCells>
+void Puzzle::snapshot(BoardStateOf<MaxCells>& state) const {
+    if (!state.fits(numRows(), numCols())) error("Board is too big for a snapshot!");
+    state.numRows = numRows();
+    state.numCols = numCols();
+    state.numFilled = _numFilled;
+    state.numInOrder = _numInOrder;
+    std::memcpy(state.cells, _cells.data(), _cells.size() * sizeof(Tile));
+    for (int i = 0; i < _numFilled; i++) {
+        state.placed[i] = _placed[i];
+    }
+}
+
+template <int MaxCells>
+void Puzzle::restore(const BoardStateOf<MaxCells>& state) {
+    if (state.numRows != numRows() || state.numCols != numCols()) error("Snapshot is of a board of another size!");
+    std::memcpy(_cells.data(), state.cells, _cells.size() * sizeof(Tile));
+    for (int i = 0; i < state.numFilled; i++) {
+        _placed[i] = state.placed[i];
+    }
+    _numFilled = state.numFilled;
+    _numInOrder = state.numInOrder;
+}
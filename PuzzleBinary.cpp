@@ -0,0 +1,312 @@
+/*
+ * File: PuzzleBinary.cpp
+ * ----------------------
+ * Writing and memory-mapped reading of compiled puzzles (see PuzzleBinary.h).
+ * The reader walks the mapped bytes with a bounds-checked cursor and builds
+ * the Puzzle and tiles straight from the id tables, with no string splitting
+ * and no string-keyed maps beyond interning each label once.
+ */
+#include "PuzzleBinary.h"
+#include "error.h"
+#include "filelib.h"
+#include "map.h"
+#include "strlib.h"
+#include "SimpleTest.h"
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#ifdef _WIN32
+#include <sstream>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+const string kPuzzleBinaryExtension = ".tpb";
+
+static const char kMagic[4] = { 'T', 'P', 'B', '1' };
+static const uint32_t kBinaryHasImages = 1;
+
+static void putU8(string& out, int value) {
+    out += char(value & 0xff);
+}
+
+static void putU16(string& out, int value) {
+    putU8(out, value);
+    putU8(out, value >> 8);
+}
+
+static void putU32(string& out, uint32_t value) {
+    putU16(out, value & 0xffff);
+    putU16(out, value >> 16);
+}
+
+bool writePuzzleBinary(string file, const PuzzleConfig& config, string configDir, bool includeImages, string& reason) {
+    try {
+        // file ids in the order labels are first seen, 0 stays the blank label
+        Vector<string> labels(1, "");
+        Map<string, int> fileIds;
+        auto fileId = [&labels, &fileIds](const string& label) {
+            if (label.empty()) return 0;
+            if (!fileIds.containsKey(label)) {
+                if (labels.size() == MAX_LABELS) throw string("Too many distinct edge labels");
+                if (label.size() > 255) throw "Edge label too long: " + label;
+                fileIds[label] = labels.size();
+                labels.add(label);
+            }
+            return fileIds[label];
+        };
+        for (const string& label : config.pairs) {
+            fileId(label);
+        }
+        for (const Tile& tile : config.tiles) {
+            for (Direction dir = NORTH; dir <= WEST; dir++) fileId(tile.getEdge(dir));
+        }
+
+        string out(kMagic, sizeof(kMagic));
+        putU16(out, config.dim.row);
+        putU16(out, config.dim.col);
+        putU16(out, labels.size());
+        putU16(out, config.tiles.size());
+        putU32(out, includeImages ? kBinaryHasImages : 0);
+        for (const string& label : labels) {
+            putU8(out, label.size());
+            out += label;
+        }
+        for (const string& label : labels) {
+            putU8(out, config.pairs.containsKey(label) ? fileIds[config.pairs.get(label)] : 0);
+        }
+        for (const Tile& tile : config.tiles) {
+            for (Direction dir = NORTH; dir <= WEST; dir++) putU8(out, fileIds[tile.getEdge(dir)]);
+        }
+        if (includeImages) {
+            string prefix = configDir.empty() ? "" : configDir + "/";
+            for (const string& path : config.imagePaths) {
+                string relative = startsWith(path, prefix) ? path.substr(prefix.size()) : path;
+                if (relative.size() > 0xffff) throw "Image path too long: " + relative;
+                putU16(out, relative.size());
+                out += relative;
+            }
+        }
+
+        ofstream stream(file, ios::binary);
+        if (!stream.write(out.data(), out.size())) throw "Cannot write " + file;
+        return true;
+    } catch (const string& msg) {
+        reason = msg;
+    } catch (char const* msg) {
+        reason = msg;
+    } catch (ErrorException& ex) {
+        reason = ex.getMessage();
+    }
+    return false;
+}
+
+/*
+ * Read-only view of a whole file. Mapped where the platform has mmap, read
+ * into memory otherwise.
+ */
+class MappedFile {
+public:
+    explicit MappedFile(const string& file) {
+#ifdef _WIN32
+        ifstream in(file, ios::binary);
+        if (!in) return;
+        ostringstream contents;
+        contents << in.rdbuf();
+        _buffer = contents.str();
+        _data = reinterpret_cast<const uint8_t*>(_buffer.data());
+        _size = _buffer.size();
+        _open = true;
+#else
+        int fd = open(file.c_str(), O_RDONLY);
+        if (fd < 0) return;
+        struct stat info;
+        if (fstat(fd, &info) == 0) {
+            _size = info.st_size;
+            _open = true;
+            if (_size > 0) {
+                void* map = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (map == MAP_FAILED) _open = false;
+                else _data = static_cast<const uint8_t*>(map);
+            }
+        }
+        close(fd);
+#endif
+    }
+
+    ~MappedFile() {
+#ifndef _WIN32
+        if (_data) munmap(const_cast<uint8_t*>(_data), _size);
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool isOpen() const { return _open; }
+    const uint8_t* data() const { return _data; }
+    size_t size() const { return _size; }
+
+private:
+    const uint8_t* _data = nullptr;
+    size_t _size = 0;
+    bool _open = false;
+#ifdef _WIN32
+    string _buffer;
+#endif
+};
+
+// bounds-checked walk over the mapped bytes
+struct Cursor {
+    const uint8_t* data;
+    size_t size;
+    size_t pos;
+
+    const uint8_t* take(size_t n) {
+        if (size - pos < n) throw "Compiled puzzle is truncated";
+        const uint8_t* at = data + pos;
+        pos += n;
+        return at;
+    }
+    int u8() { return *take(1); }
+    int u16() { const uint8_t* at = take(2); return at[0] | at[1] << 8; }
+    uint32_t u32() { uint32_t low = u16(); return low | uint32_t(u16()) << 16; }
+};
+
+bool loadPuzzleBinary(string file, Puzzle& puzzle, Vector<Tile>& tiles, string& reason, Vector<string>* imagePaths) {
+    LabelScope labels;
+    try {
+        MappedFile mapped(file);
+        if (!mapped.isOpen()) throw "No such file";
+        Cursor in = { mapped.data(), mapped.size(), 0 };
+        if (memcmp(in.take(sizeof(kMagic)), kMagic, sizeof(kMagic)) != 0) throw "Not a compiled puzzle: " + file;
+        int rows = in.u16(), cols = in.u16(), numLabels = in.u16(), numTiles = in.u16();
+        uint32_t flags = in.u32();
+        if (rows == 0 || cols == 0) throw string("Compiled puzzle has no dimensions");
+        if (numLabels == 0 || numLabels > MAX_LABELS) throw string("Compiled puzzle has a bad label count");
+        if (numTiles != rows * cols) throw "Mismatch in size, dimensions = r" + integerToString(rows) + "c" + integerToString(cols)
+                                          + " count of tiles = " + integerToString(numTiles);
+
+        LabelId ids[MAX_LABELS];  // file id to program id
+        for (int i = 0; i < numLabels; i++) {
+            int length = in.u8();
+            const char* bytes = reinterpret_cast<const char*>(in.take(length));
+            if ((i == 0) != (length == 0)) throw string("Compiled puzzle has a bad label table");
+            ids[i] = (i == 0) ? BLANK_LABEL : Tile::internLabel(string(bytes, length));
+        }
+        auto idAt = [&in, &ids, numLabels]() {
+            int fileId = in.u8();
+            if (fileId >= numLabels) throw string("Compiled puzzle has a bad label id");
+            return ids[fileId];
+        };
+        LabelId complement[MAX_LABELS] = {};
+        for (int i = 0; i < numLabels; i++) {
+            LabelId opposite = idAt();
+            if (i != 0) complement[ids[i]] = opposite;
+        }
+        // decoded into locals, the outputs are only touched once the whole file has been read
+        Vector<Tile> fileTiles;
+        for (int i = 0; i < numTiles; i++) {
+            LabelId north = idAt(), east = idAt(), south = idAt(), west = idAt();
+            fileTiles.add(Tile(north, east, south, west));
+        }
+        Vector<string> paths;
+        if (imagePaths && (flags & kBinaryHasImages)) {
+            string dir = getHead(file);
+            for (int i = 0; i < numTiles; i++) {
+                int length = in.u16();
+                string relative(reinterpret_cast<const char*>(in.take(length)), length);
+                paths.add(dir.empty() ? relative : dir + "/" + relative);
+            }
+        }
+        puzzle.configure(rows, cols, complement);
+        tiles = fileTiles;
+        if (imagePaths) *imagePaths = paths;
+        labels.commit();
+        return true;
+    } catch (const string& msg) {
+        reason = msg;
+    } catch (char const* msg) {
+        reason = msg;
+    } catch (ErrorException& ex) {
+        reason = ex.getMessage();
+    }
+    return false;
+}
+
+/* * * * * * Test Cases * * * * * */
+
+// the labels of each tile as strings, readable after another puzzle replaces the label table
+static Vector<string> edgeStrings(const Vector<Tile>& tiles) {
+    Vector<string> edges;
+    for (const Tile& tile : tiles) {
+        for (Direction dir = NORTH; dir <= WEST; dir++) edges.add(tile.getEdge(dir));
+    }
+    return edges;
+}
+
+STUDENT_TEST("a compiled puzzle loads back the same size, pairs, tiles and image names") {
+    PuzzleConfig config;
+    string reason;
+    EXPECT(readPuzzleConfig("puzzles/cola/cola.txt", config, reason));
+    Vector<string> edges = edgeStrings(config.tiles);
+    string file = getTempDirectory() + "/cola-round-trip" + kPuzzleBinaryExtension;
+    EXPECT(writePuzzleBinary(file, config, "puzzles/cola", true, reason));
+
+    Puzzle puzzle;
+    Vector<Tile> tiles;
+    Vector<string> images;
+    EXPECT(loadPuzzleBinary(file, puzzle, tiles, reason, &images));
+    EXPECT_EQUAL(puzzle.numRows(), config.dim.row);
+    EXPECT_EQUAL(puzzle.numCols(), config.dim.col);
+    EXPECT_EQUAL(edgeStrings(tiles), edges);
+    for (const string& label : config.pairs) {
+        EXPECT_EQUAL(Tile::labelString(puzzle.complementOf(Tile::internLabel(label))), config.pairs[label]);
+    }
+    EXPECT_EQUAL(images.size(), config.imagePaths.size());
+    for (int i = 0; i < images.size() && i < config.imagePaths.size(); i++) {
+        EXPECT_EQUAL(getTail(images[i]), getTail(config.imagePaths[i]));
+    }
+    deleteFile(file);
+}
+
+STUDENT_TEST("a truncated or corrupt compiled puzzle is rejected and the outputs are left alone") {
+    PuzzleConfig config;
+    string reason;
+    EXPECT(readPuzzleConfig("puzzles/cola/cola.txt", config, reason));
+    string file = getTempDirectory() + "/cola-damaged" + kPuzzleBinaryExtension;
+    EXPECT(writePuzzleBinary(file, config, "puzzles/cola", true, reason));
+    ifstream in(file, ios::binary);
+    string bytes((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+    in.close();
+
+    string truncated = bytes.substr(0, bytes.size() / 2);
+    string badMagic = bytes;
+    badMagic[0] = 'X';
+    string badCount = bytes;
+    badCount[10]++;  // low byte of numTiles, which no longer matches rows * cols
+    for (const string& damaged : { truncated, badMagic, badCount }) {
+        ofstream out(file, ios::binary | ios::trunc);
+        out << damaged;
+        out.close();
+
+        Puzzle puzzle;
+        Vector<Tile> tiles;
+        Vector<string> images = { "untouched" };
+        EXPECT(loadPuzzleFile("puzzles/turtles/turtles.txt", puzzle, tiles, reason));
+        Vector<string> edges = edgeStrings(tiles);
+        reason = "";
+        EXPECT(!loadPuzzleBinary(file, puzzle, tiles, reason, &images));
+        EXPECT(reason != "");
+        EXPECT_EQUAL(puzzle.numRows(), 3);
+        EXPECT(puzzle.hasCurrentLabels());
+        EXPECT_EQUAL(edgeStrings(tiles), edges);
+        EXPECT_EQUAL(images, Vector<string>{ "untouched" });
+    }
+    deleteFile(file);
+}
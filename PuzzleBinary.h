@@ -0,0 +1,50 @@
+#pragma once
+
+#include <string>
+#include "Puzzle.h"
+#include "PuzzleConfig.h"
+#include "Tile.h"
+#include "vector.h"
+
+/**
+ * Compiled puzzles
+ * ----------------
+ * A puzzle configuration compiled to a compact binary file (extension .tpb)
+ * that loads without any text parsing. All integers are little-endian:
+ *
+ *     header      "TPB1", uint16 rows, uint16 cols, uint16 numLabels,
+ *                 uint16 numTiles, uint32 flags
+ *     labels      numLabels entries of uint8 length + bytes; entry 0 is the
+ *                 empty blank label, file label ids index this table
+ *     complement  numLabels bytes, the file id of each label's opposite
+ *     tiles       numTiles entries of 4 file label ids, N-E-S-W
+ *     images      only if flags has kBinaryHasImages: numTiles entries of
+ *                 uint16 length + bytes, paths relative to the file's folder
+ *
+ * File label ids are local to the file; the loader interns each label once and
+ * translates the tables, so the tiles it returns use the program's label ids.
+ */
+extern const std::string kPuzzleBinaryExtension;
+
+/**
+ * writePuzzleBinary
+ * -----------------
+ * Compiles a configuration read by readPuzzleConfig into file. configDir is
+ * the folder of the .txt file, image paths are stored relative to it when
+ * includeImages is true. Returns false and sets reason on any error.
+ */
+bool writePuzzleBinary(std::string file, const PuzzleConfig& config, std::string configDir,
+                       bool includeImages, std::string& reason);
+
+/**
+ * loadPuzzleBinary
+ * ----------------
+ * Memory-maps a compiled puzzle, configures puzzle from it and fills tiles in
+ * file order. If imagePaths is given and the file has image references, it is
+ * filled with their paths, resolved against the file's folder. Returns false
+ * and sets reason if the file is missing, truncated or inconsistent; puzzle,
+ * tiles and imagePaths are then left as they were. The labels get a new table
+ * (see LabelScope in Tile.h) only if the load succeeds.
+ */
+bool loadPuzzleBinary(std::string file, Puzzle& puzzle, Vector<Tile>& tiles, std::string& reason,
+                      Vector<std::string>* imagePaths = nullptr);
@@ -0,0 +1,98 @@
+/*
+ * File: PuzzleConfig.cpp
+ * ----------------------
+ * Reading of puzzle configuration files, shared by the GUI and the headless
+ * tools. The format is the dimensions line (rNcM), a line of label=opposite
+ * pairs, then one image file name per tile with edges named N-E-S-W.
+ */
+#include "PuzzleConfig.h"
+#include "PuzzleBinary.h"
+#include "error.h"
+#include "filelib.h"
+#include "set.h"
+#include "strlib.h"
+#include <fstream>
+#include <sstream>
+
+using namespace std;
+
+bool readPuzzleConfig(string configFile, PuzzleConfig& config, string& reason) {
+    LabelScope labels;
+    try {
+        string dir = getHead(configFile);
+        ifstream in;
+        if (configFile.empty() || !openFile(in, configFile)) throw "No such file";
+        auto readNext = [&in]() {
+            string cur;
+            do {
+                if (!getline(in, cur)) break;
+                trimInPlace(cur);
+            } while (cur.empty() || startsWith(cur, "#"));
+            return cur;
+        };
+        string line = readNext();
+        istringstream stream(line);
+        if (!(stream >> config.dim)) throw "First line does not contain dimensions, expected rNcN, found " + line;
+        for (const auto& pair: stringSplit(readNext(), " ")) {
+            Vector<string> tokens = stringSplit(pair, "=");
+            if (tokens.size() != 2) throw "Malformed pair, expected format label=opposite, found " + pair;
+            config.pairs[tokens[0]] = tokens[1]; // add self and inverse
+            config.pairs[tokens[1]] = tokens[0];
+        }
+        Set<Tile> seen;
+        string filename;
+        while ((filename = readNext()) != "") {
+            string path = dir + "/" + filename;
+            string basename = getRoot(filename);
+            if (!fileExists(path)) throw "No such image file: " + basename;
+            Vector<string> edges = stringSplit(basename, "-");
+            if (edges.size() < NUM_SIDES) throw "Tile image file name not in proper format, expected edges in N-E-S-W, found " + basename;
+            Tile tile(edges[NORTH], edges[EAST], edges[SOUTH], edges[WEST]);
+            if (seen.contains(tile)) throw "Duplicate tile listed twice: " + basename;
+            for (Direction dir = NORTH; dir <= WEST; dir++) {
+                if (!config.pairs.containsKey(tile.getEdge(dir))) throw "Edge label " + tile.getEdge(dir) + " of tile " + basename + " does not have matching entry in pairs";
+            }
+            seen.add(tile);
+            config.tiles.add(tile);
+            config.imagePaths.add(path);
+        }
+        if (config.tiles.size() != config.dim.row*config.dim.col) throw "Mismatch in size, dimensions = " + config.dim.toString() + " count of tiles = " + integerToString(config.tiles.size());
+        labels.commit();
+        return true;
+    } catch (const string& msg) {
+        reason = msg;
+    } catch (char const* msg) {
+        reason = msg;
+    } catch (ErrorException& ex) {
+        reason = ex.getMessage();
+    }
+    return false;
+}
+
+void gatherPuzzleFiles(string path, Vector<string>& files, bool preferCompiled, string skipFolder) {
+    if (!isDirectory(path)) {
+        files.add(path);
+        return;
+    }
+    for (const string& entry : listDirectory(path)) {
+        string child = path + "/" + entry;
+        string stem = child.substr(0, child.size() - getExtension(child).size());
+        if (isDirectory(child)) {
+            if (entry != skipFolder) gatherPuzzleFiles(child, files, preferCompiled, skipFolder);
+        } else if (endsWith(entry, ".txt")) {
+            bool compiled = preferCompiled && fileExists(stem + kPuzzleBinaryExtension);
+            files.add(compiled ? stem + kPuzzleBinaryExtension : child);
+        } else if (preferCompiled && endsWith(entry, kPuzzleBinaryExtension) && !fileExists(stem + ".txt")) {
+            files.add(child);
+        }
+    }
+}
+
+bool loadPuzzleFile(string configFile, Puzzle& puzzle, Vector<Tile>& tiles, string& reason) {
+    if (endsWith(configFile, kPuzzleBinaryExtension)) return loadPuzzleBinary(configFile, puzzle, tiles, reason);
+    PuzzleConfig config;
+    if (!readPuzzleConfig(configFile, config, reason)) return false;
+    puzzle.configure(config.dim.row, config.dim.col, config.pairs);
+    tiles = config.tiles;
+    return true;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <string>
+#include "Puzzle.h"
+#include "Tile.h"
+#include "gridlocation.h"
+#include "map.h"
+#include "vector.h"
+
+/**
+ * PuzzleConfig
+ * ------------
+ * Everything read from a puzzle configuration file, with no graphics attached.
+ * The tiles are listed in file order and imagePaths[i] is the path of the
+ * image file that tiles[i] was named after.
+ */
+struct PuzzleConfig {
+    GridLocation dim;
+    Map<std::string, std::string> pairs;
+    Vector<Tile> tiles;
+    Vector<std::string> imagePaths;
+};
+
+/**
+ * readPuzzleConfig
+ * ----------------
+ * Reads and validates the puzzle configuration file. Returns true on success.
+ * On any error returns false and sets reason to a description of the problem;
+ * config then still holds the tiles and image paths of the lines validated
+ * before the error. This function does no rendering and can be used without
+ * a display. A successful read starts a new label table (see LabelScope in
+ * Tile.h), so the tiles of a puzzle read earlier no longer print correctly;
+ * after a failed one the previous table is back and config.tiles are stale.
+ */
+bool readPuzzleConfig(std::string configFile, PuzzleConfig& config, std::string& reason);
+
+/**
+ * loadPuzzleFile
+ * --------------
+ * Convenience for headless callers: reads the configuration file, configures
+ * puzzle to the given dimensions and pairs, and fills tiles with the tiles
+ * listed in the file. A file ending in .tpb is loaded as a compiled puzzle
+ * (see PuzzleBinary.h). Returns false and sets reason on any error.
+ */
+bool loadPuzzleFile(std::string configFile, Puzzle& puzzle, Vector<Tile>& tiles, std::string& reason);
+
+/**
+ * gatherPuzzleFiles
+ * -----------------
+ * Expands a path named on the command line of a headless tool into files.
+ * A file is added as given. A directory stands for every .txt config below it,
+ * skipping folders named skipFolder. With preferCompiled, a config that has a
+ * compiled .tpb beside it (see puzzle-compile) is listed as the .tpb, and a
+ * .tpb with no config beside it is listed too; recompile after editing a
+ * config, as the .tpb is used whether or not it is current.
+ */
+void gatherPuzzleFiles(std::string path, Vector<std::string>& files, bool preferCompiled = false,
+                       std::string skipFolder = "");
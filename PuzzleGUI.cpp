@@ -5,6 +5,8 @@
  * Implementation of graphics/gui support for Tile Match.
  */
 #include "PuzzleGUI.h"
+#include "PuzzleConfig.h"
+#include "WorkStealingPool.h"
 #include "filelib.h"
 #include "console.h"
 #include "gconsolewindow.h"
@@ -14,7 +16,18 @@
 #include "goptionpane.h"
 #include "gthread.h"
 #include "gwindow.h"
+#include "grid.h"
+#include "hashmap.h"
+#include "set.h"
 #include <QApplication>
+#include <QImage>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
 
 typedef Vector<Tile> Collection;
 
@@ -26,19 +39,44 @@ static const int kNoSelection = -1;
 
 // JDZ: module-private globals
 static Action gAction;
+static mutex gActionLock;                   // guards gAction
+static condition_variable gActionChanged;   // playInteractive sleeps on this
+static atomic<bool> gCancelSolve(false);
+static GInteractor *gCancelButton;
 static GWindow *gWin;
 static GCanvas *gCanvas;
 static Vector<GInteractor *> gControls;
-struct TileInfo {
-    struct {
-        GImage *img;
-        string sideStr;
-    } rotations[NUM_SIDES];
-    GCompound *compound;    // contains all rotations + frame
+// every tile compound stays on the canvas, hidden when not shown, and is only
+// touched when what it shows changes; DrawnTile records what it shows now
+struct DrawnTile {
+    bool visible = false;
+    int rotation = -1;              // -1 until first drawn
+    string frameColor = kUnchanged; // kUnchanged until first drawn
+    GPoint center;
+    int frameNumber = 0;            // last updateDisplay that placed the tile
+};
+// graphics for one image file, cached by path for the life of the program so
+// loading the same puzzle again reuses them. The image is decoded once and
+// downscaled to kTileSize; each rotation is rendered from it the first time
+// it is shown. A compound can only be on the canvas once, so a second tile
+// showing the same image gets graphics of its own around the shared base
+struct TileGraphic {
+    GImage *base;           // downscaled, unrotated, not on any canvas
+    GImage *rotations[NUM_SIDES];   // rotations[r] shows the tile turned r times, nullptr until needed
+    GCompound *compound;    // contains the rotations made so far + frame
     GRect *frame;
-    int index; // into stackinfo array
 };
-static Map<Tile, TileInfo> gTileInfo;
+static Map<string, TileGraphic *> gGraphicCache;
+static int gImagesDecoded, gImagesReused;  // for the load report, reset by each load
+// each tile gets a handle when the puzzle is loaded, its index in gTileInfo,
+// which is also its position in the stack
+struct TileInfo {
+    TileGraphic *graphic;
+    Tile tile;              // in its current orientation
+    DrawnTile drawn;
+};
+static Vector<TileInfo> gTileInfo;
+static HashMap<Tile, int> gHandles;    // handle of a tile in any orientation
 struct PlacementInfo {
     GPoint center;
     bool hasTile;
@@ -46,126 +84,189 @@ struct PlacementInfo {
 static Grid<PlacementInfo> gBoardInfo;
 static Vector<PlacementInfo> gStackInfo;
 static int gSelectedIndex = kNoSelection;
+static int gFrontIndex = kNoSelection;  // tile raised above the stack order
+static int gFrameNumber = 0;
 
-static bool readPuzzleConfigFile(string configFile, GridLocation& dim, Map<string,string>& pairs, Map<Tile, TileInfo>& tInfo);
+static bool readPuzzleConfigFile(string configFile, PuzzleConfig& config, Vector<TileInfo>& tInfo);
 static void resetLayout(int numRows = 3, int numCols = 3);
 static void enableInteraction(Puzzle& puzzle, Collection& tiles);
 static void disableInteraction();
 
-static void updateKey(const Tile& tile, Collection* pCol = nullptr);
-static GCompound *getTileGraphic(const Tile& tile, string frameColor = kUnchanged, GPoint* pCenter = nullptr);
+static GCompound *getTileGraphic(int handle, string frameColor = kUnchanged, GPoint* pCenter = nullptr);
+static long peakMemoryKb();
+static void arrangeZOrder();
 
 bool loadPuzzleConfig(string configFile, Puzzle& puzzle, Collection& tiles) {
-    GridLocation dim;
-    Map<string,string> pairs;
-    Map<Tile, TileInfo> tInfo;
-    if (!readPuzzleConfigFile(configFile, dim, pairs, tInfo)) {
+    PuzzleConfig config;
+    Vector<TileInfo> tInfo;
+    auto start = chrono::steady_clock::now();
+    gImagesDecoded = gImagesReused = 0;
+    LabelScope labels;  // the puzzle on display keeps its labels unless this load succeeds
+    if (!readPuzzleConfigFile(configFile, config, tInfo)) {
         if (!gWin) resetLayout();
         return false;
     }
     gTileInfo = tInfo;
-    resetLayout(dim.row, dim.col);
-    puzzle.configure(dim.row, dim.col, pairs);
+    gHandles.clear();
+    for (int i = 0; i < gTileInfo.size(); i++) { gHandles[gTileInfo[i].tile] = i; }
+    resetLayout(config.dim.row, config.dim.col);
+    puzzle.configure(config.dim.row, config.dim.col, config.pairs);
     tiles.clear();
-    for (const auto& cur: gTileInfo) { tiles.add(cur); }
+    for (const auto& cur: gTileInfo) { tiles.add(cur.tile); }
+    labels.commit();
+    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    cout << "Loaded " << getTail(configFile) << " in " << ms << " ms, " << gImagesDecoded << " images decoded, "
+         << gImagesReused << " from cache, peak memory " << peakMemoryKb() / 1024 << " MB" << endl;
     return true;
 }
 
+static int handleOf(const Tile& tile) {
+    if (!gHandles.containsKey(tile)) error("TileGUI internal error missing image for tile!");
+    return gHandles[tile];
+}
+
 Action playInteractive(Puzzle& puzzle, Collection& tiles) {
     if (!gWin) resetLayout();
     updateDisplay(puzzle, tiles);
     enableInteraction(puzzle, tiles);
+    unique_lock<mutex> guard(gActionLock);
+    gActionChanged.wait(guard, [] { return gAction != NONE; });
+    Action action = gAction;
     gAction = NONE;
-    while (gAction == NONE) { std::this_thread::yield(); }
+    guard.unlock();
     disableInteraction();
-    return gAction;
+    return action;
+}
+
+// shows tile at center with the given frame, only touching what changed since the last frame
+static void showTile(int handle, GPoint center, string frameColor) {
+    GCompound *c = getTileGraphic(handle, frameColor, &center);
+    DrawnTile& drawn = gTileInfo[handle].drawn;
+    if (!drawn.visible) {
+        c->setVisible(true);
+        drawn.visible = true;
+    }
+    drawn.frameNumber = gFrameNumber;
 }
 
 void updateDisplay(const Puzzle& puzzle, const Collection& tiles, int pauseMs) {
     if (!gWin) error("TileGUI not properly initialized!");
-    auto addTileAt = [&](Tile t, GPoint p, string fc) {
-        GCompound *c = getTileGraphic(t, fc, &p);
-        gCanvas->add(c);
-    };
-    gCanvas->clearObjects(); // remove all tiles from canvas
+    gFrameNumber++;
     for (auto& cur : gStackInfo) { cur.hasTile = false; }
     for (auto& cur : gBoardInfo) { cur.hasTile = false; }
     for (const auto& tile: tiles) { // iterate and set flag
         if (tile.isBlank()) continue;
-        int index = gTileInfo[tile].index;
-        gStackInfo[index].hasTile = true;
-        updateKey(tile);
-    }
-    Vector<Tile> v = gTileInfo.keys();
-    for (int i = gStackInfo.size() - 1; i >= 0; i--) {  // add in back-to-front z-order
-        if (!gStackInfo[i].hasTile) continue;
-        if (i == gSelectedIndex) continue; // add selected after loop so it will be in front
-        addTileAt(v[i], gStackInfo[i].center, "");
-    }
-    if (gSelectedIndex != kNoSelection) {
-        Tile which = v[gSelectedIndex];
-        string frameColor = puzzle.canAdd(which) ? kMatchColor : kSelectColor;
-        addTileAt(which, gStackInfo[gSelectedIndex].center, frameColor);
+        int handle = handleOf(tile);
+        gStackInfo[handle].hasTile = true;
+        gTileInfo[handle].tile = tile;
+        string frameColor = "";
+        if (handle == gSelectedIndex) frameColor = puzzle.canAdd(tile) ? kMatchColor : kSelectColor;
+        showTile(handle, gStackInfo[handle].center, frameColor);
     }
     for (const auto& loc: gBoardInfo.locations()) {
         Tile tile = puzzle.tileAt(loc);
         if (tile.isBlank()) continue;
-        addTileAt(tile, gBoardInfo[loc].center, "");
+        int handle = handleOf(tile);
+        gTileInfo[handle].tile = tile;
+        showTile(handle, gBoardInfo[loc].center, "");
         gBoardInfo[loc].hasTile = true;
-        updateKey(tile);
     }
+    for (auto& info : gTileInfo) { // hide tiles no longer in the stack or on the board
+        if (info.drawn.visible && info.drawn.frameNumber != gFrameNumber) {
+            info.graphic->compound->setVisible(false);
+            info.drawn.visible = false;
+        }
+    }
+    arrangeZOrder();
     GThread::runOnQtGuiThread([] { gCanvas->repaint(); });
     if (pauseMs) pause(pauseMs);
 }
 
-static GCompound *getTileGraphic(const Tile& tile, string frameColor, GPoint* pCenter) {
-    if (!gTileInfo.containsKey(tile)) error("TileGUI internal error missing image for tile!");
-    TileInfo& info = gTileInfo[tile];
-    string facing = tile.toString();
-    for (int i = 0; i < NUM_SIDES; i++) {
-        info.rotations[i].img->setVisible(info.rotations[i].sideStr == facing);
+// stack tiles overlap, so they are kept in back-to-front index order with the
+// selected tile raised to the front. Reordering re-adds every compound, but
+// only happens when the selection changes
+static void arrangeZOrder() {
+    if (gFrontIndex == gSelectedIndex) return;
+    if (gFrontIndex != kNoSelection) {
+        for (int i = gTileInfo.size() - 1; i >= 0; i--) {
+            GCompound *c = gTileInfo[i].graphic->compound;
+            gCanvas->remove(c);
+            gCanvas->add(c);
+        }
     }
-    if (frameColor != kUnchanged) {
-        info.frame->setVisible(!frameColor.empty());
-        info.frame->setColor(frameColor);
+    if (gSelectedIndex != kNoSelection) {
+        //c->sendToFront(); // GCompound has sendToFront with argument that shadows inherited
+        GCompound *c = gTileInfo[gSelectedIndex].graphic->compound;
+        gCanvas->remove(c);   // corrected version operates manually
+        gCanvas->add(c);
     }
-    if (pCenter) {
-        // move all objects individually cause GCompound does not
-        // draw offset as promised
-        for (int i = 0; i < info.compound->getElementCount(); i++) {
-            info.compound->getElement(i)->setCenterLocation(*pCenter);
-        }
-        info.compound->setCenterLocation(*pCenter);
+    gFrontIndex = gSelectedIndex;
+}
+
+// renders rotation from the downscaled base image the first time it is needed
+static GImage *getRotationImage(TileGraphic *g, int rotation, GPoint center) {
+    if (g->rotations[rotation]) return g->rotations[rotation];
+    GCanvas *offscreen = new GCanvas(kTileSize, kTileSize);
+    // ideally would reuse single offscreen canvas, but internally sharing one QImage, ugh
+    GImage *img = g->base;
+    img->resetTransform();
+    img->rotate(90 * rotation); // each rotate transforms 90 deg around top left
+    switch (rotation) { // translate location to compensate
+        case 0: img->setCenterLocation( kTileSize/2,  kTileSize/2); break;
+        case 1: img->setCenterLocation( kTileSize/2, -kTileSize/2); break;
+        case 2: img->setCenterLocation(-kTileSize/2, -kTileSize/2); break;
+        case 3: img->setCenterLocation(-kTileSize/2,  kTileSize/2); break;
     }
-    return info.compound;
+    offscreen->draw(img);
+    g->rotations[rotation] = offscreen->toGImage();
+    g->rotations[rotation]->setCenterLocation(center); // join the other elements of the compound
+    g->compound->remove(g->frame);
+    g->compound->add(g->rotations[rotation]);
+    g->compound->add(g->frame); // keep frame on top of image
+    return g->rotations[rotation];
 }
 
-static void updateKey(const Tile& tile, Collection* pColl) {
-    auto saved = gTileInfo[tile];   // JDZ ugly hack used to
-    gTileInfo.remove(tile); // overwrite key with possibly rotated copy
-    gTileInfo[tile] = saved;
-    if (pColl) { // similar hack to replace entry in collection
-        Collection copy;
-        for (auto cur: *pColl) { copy.add(cur == tile ? tile : cur); }
-        *pColl = copy;
+static GCompound *getTileGraphic(int handle, string frameColor, GPoint* pCenter) {
+    TileInfo& info = gTileInfo[handle];
+    TileGraphic *g = info.graphic;
+    DrawnTile& drawn = info.drawn;
+    int rotation = info.tile.getRotation();
+    if (rotation != drawn.rotation) {
+        getRotationImage(g, rotation, drawn.center);
+        for (int i = 0; i < NUM_SIDES; i++) {
+            if (g->rotations[i]) g->rotations[i]->setVisible(i == rotation);
+        }
+        drawn.rotation = rotation;
+    }
+    if (frameColor != kUnchanged && frameColor != drawn.frameColor) {
+        g->frame->setVisible(!frameColor.empty());
+        g->frame->setColor(frameColor);
+        drawn.frameColor = frameColor;
+    }
+    if (pCenter && !(*pCenter == drawn.center)) {
+        drawn.center = *pCenter;
+        // move all objects individually cause GCompound does not
+        // draw offset as promised
+        for (int i = 0; i < g->compound->getElementCount(); i++) {
+            g->compound->getElement(i)->setCenterLocation(*pCenter);
+        }
+        g->compound->setCenterLocation(*pCenter);
     }
+    return g->compound;
 }
 
 static bool getSelectedTile(Tile& tile) {
     if (gSelectedIndex == kNoSelection || !gStackInfo[gSelectedIndex].hasTile) return false;
-    tile = gTileInfo.keys()[gSelectedIndex];
+    tile = gTileInfo[gSelectedIndex].tile;
     return true;
 }
 
 static bool selectIndex(int newIndex, const Puzzle& puzzle) {
-    for (const auto& cur : gTileInfo) gTileInfo[cur].frame->setVisible(false);
+    if (gSelectedIndex != kNoSelection) getTileGraphic(gSelectedIndex, "");
     gSelectedIndex = newIndex;
-    Tile selected = gTileInfo.keys()[newIndex];
-    string frameColor = puzzle.canAdd(selected) ? kMatchColor : kSelectColor;
-    GCompound* c = getTileGraphic(selected, frameColor);
-    //c->sendToFront(); // GCompound has sendToFront with argument that shadows inherited
-    gCanvas->remove(c);   // corrected version operates manually
-    gCanvas->add(c);
+    string frameColor = puzzle.canAdd(gTileInfo[newIndex].tile) ? kMatchColor : kSelectColor;
+    getTileGraphic(newIndex, frameColor);
+    arrangeZOrder();
     GThread::runOnQtGuiThread([] { gCanvas->repaint(); });
     return true;
 }
@@ -188,9 +289,12 @@ static bool rotate(int numTurns, const Puzzle& puzzle, Collection& tiles) {
     Tile tile;
     if (!getSelectedTile(tile)) return false;
     for (int i = 0; i < numTurns; i++) tile.rotate();
+    gTileInfo[gSelectedIndex].tile = tile;
     string frameColor = puzzle.canAdd(tile) ? kMatchColor : kSelectColor;
-    getTileGraphic(tile, frameColor);  // will change visibility of rotated images to match orientation
-    updateKey(tile, &tiles);
+    getTileGraphic(gSelectedIndex, frameColor);  // will change visibility of rotated images to match orientation
+    for (auto& cur : tiles) { // turn the model's copy in place too
+        if (cur == tile) { cur = tile; break; }
+    }
     GThread::runOnQtGuiThread([] { gCanvas->repaint(); });
     return true;
 }
@@ -198,9 +302,9 @@ static bool rotate(int numTurns, const Puzzle& puzzle, Collection& tiles) {
 static bool place(Puzzle& puzzle, Collection& tiles) {
     Tile which;
     if (!getSelectedTile(which) || !puzzle.canAdd(which)) return false;
-    Collection without; // JDZ clumsy universal remove from either Set or Vector
-    for (auto t: tiles) { if (!(t == which)) without.add(t);}
-    tiles = without;
+    for (int i = 0; i < tiles.size(); i++) {
+        if (tiles[i] == which) { tiles.remove(i); break; }
+    }
     puzzle.add(which);
     up(puzzle) || down(puzzle); // move select to neighbor tile in stack
     updateDisplay(puzzle, tiles); // redraw from model
@@ -210,26 +314,21 @@ static bool place(Puzzle& puzzle, Collection& tiles) {
 static bool remove(Puzzle& puzzle, Collection& tiles) {
     if (puzzle.isEmpty()) return false;
     Tile which = puzzle.remove();
-    selectIndex(gTileInfo[which].index, puzzle);
+    selectIndex(handleOf(which), puzzle);
     tiles.add(which);
     updateDisplay(puzzle, tiles); // redraw from model
     return true;
 }
 
+static bool hitTile(int handle, GEvent e) {
+    return gTileInfo[handle].drawn.visible && gTileInfo[handle].graphic->compound->contains(e.getX(), e.getY());
+}
+
 static bool handleClick(GEvent e, const Puzzle& puzzle) {
-    // corrected version of hit test, need to search backwards (indexed z order background to foreground)
-    GObject *hit = nullptr;
-    for (int i = gCanvas->getElementCount()-1; i >= 0; i--) {
-        GObject* cur = gCanvas->getElement(i);
-        if (cur->contains(e.getX(), e.getY())) {
-            hit = cur; break;
-        }
-    }
-    if (!hit) return false;
-    for (const auto& tile: gTileInfo) {
-        if (gTileInfo[tile].compound == hit) {
-            return selectIndex(gTileInfo[tile].index, puzzle);
-        }
+    // the canvas z order is known (see arrangeZOrder), so test tiles front to back by handle
+    if (gFrontIndex != kNoSelection && hitTile(gFrontIndex, e)) return selectIndex(gFrontIndex, puzzle);
+    for (int handle = 0; handle < gTileInfo.size(); handle++) {
+        if (hitTile(handle, e)) return selectIndex(handle, puzzle);
     }
     return false;
 }
@@ -247,38 +346,77 @@ static bool handleKey(GEvent e, Puzzle& puzzle, Collection& tiles) {
     }
 }
 
-static TileInfo createTileGraphic(string path, Tile tile) {
-    TileInfo info;
-    info.compound = new GCompound();
-    // workaround to fix wrong compound bounds, add point in upperleft/lowerright
-    info.compound->add(new GRect(0, 0, 0, 0));
-    info.compound->add(new GRect(kTileSize, kTileSize, 0, 0));
-    info.frame = new GRect(0, 0,  kTileSize, kTileSize);
-    info.frame->setColor(kSelectColor);
-    info.frame->setLineWidth(kFrameWidth);
-    info.frame->setVisible(false);
-    GImage *img = new GImage(path);
-    img->setSize(kTileSize, kTileSize);
-    // create 4 copies, one for each rotation, add to cache
-    for (int orientation = 0; orientation < NUM_SIDES; orientation++) {
-        GCanvas *offscreen = new GCanvas(kTileSize, kTileSize);
-        // ideally would reuse single offscreen canvas, but internally sharing one QImage, ugh
-        img->resetTransform();
-        img->rotate(90 * orientation); // each rotate transforms 90 deg around top left
-        if (orientation != 0) tile.rotate();
-        switch (orientation) { // translate location to compensate
-            case 0: img->setCenterLocation( kTileSize/2,  kTileSize/2); break;
-            case 1: img->setCenterLocation( kTileSize/2, -kTileSize/2); break;
-            case 2: img->setCenterLocation(-kTileSize/2, -kTileSize/2); break;
-            case 3: img->setCenterLocation(-kTileSize/2,  kTileSize/2); break;
+// peak resident set size of the program in kilobytes, 0 where unsupported
+static long peakMemoryKb() {
+#ifndef _WIN32
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#ifdef __APPLE__
+        return usage.ru_maxrss / 1024;  // bytes on macOS
+#else
+        return usage.ru_maxrss;
+#endif
+    }
+#endif
+    return 0;
+}
+
+// decodes the image at path and scales it to kTileSize. Uses only QImage, so
+// it is safe to run off the GUI thread
+static bool decodeTileImage(string path, Grid<int>& pixels) {
+    QImage image(QString::fromStdString(path));
+    if (image.isNull()) return false;
+    int size = int(kTileSize);
+    QImage scaled = image.scaled(size, size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation)
+                         .convertToFormat(QImage::Format_ARGB32);
+    pixels.resize(size, size);
+    for (int y = 0; y < size; y++) {
+        const QRgb *line = reinterpret_cast<const QRgb *>(scaled.constScanLine(y));
+        for (int x = 0; x < size; x++) {
+            pixels.set(y, x, int(line[x]));
         }
-        offscreen->draw(img);
-        info.rotations[orientation].img = offscreen->toGImage();
-        info.rotations[orientation].sideStr = tile.toString();
-        info.compound->add(info.rotations[orientation].img);
     }
-    info.compound->add(info.frame); // add frame last to put on top of image
-    return info;
+    return true;
+}
+
+// builds the compound and frame around a downscaled image
+static TileGraphic *newTileGraphic(GImage *base) {
+    TileGraphic *g = new TileGraphic();
+    g->base = base;
+    g->compound = new GCompound();
+    // workaround to fix wrong compound bounds, add point in upperleft/lowerright
+    g->compound->add(new GRect(0, 0, 0, 0));
+    g->compound->add(new GRect(kTileSize, kTileSize, 0, 0));
+    g->frame = new GRect(0, 0,  kTileSize, kTileSize);
+    g->frame->setColor(kSelectColor);
+    g->frame->setLineWidth(kFrameWidth);
+    g->frame->setVisible(false);
+    g->compound->add(g->frame); // frame stays last to put on top of image
+    return g;
+}
+
+// the graphics for a newly decoded image, cached by path
+static TileGraphic *cacheTileGraphic(string path, GImage *base) {
+    gImagesDecoded++;
+    TileGraphic *g = newTileGraphic(base);
+    gGraphicCache[path] = g;
+    return g;
+}
+
+static TileGraphic *createTileGraphic(string path, const Grid<int>& pixels) {
+    GCanvas *offscreen = new GCanvas(kTileSize, kTileSize);
+    offscreen->setPixelsARGB(pixels);
+    return cacheTileGraphic(path, offscreen->toGImage());
+}
+
+// decodes on the GUI thread through GImage, which raises the library's error for a bad file
+static TileGraphic *createTileGraphic(string path) {
+    GImage *full = new GImage(path);
+    full->setSize(kTileSize, kTileSize);
+    GCanvas *offscreen = new GCanvas(kTileSize, kTileSize);
+    offscreen->draw(full);
+    delete full;
+    return cacheTileGraphic(path, offscreen->toGImage()); // keep only the downscaled pixels
 }
 
 static void enableInteraction(Puzzle& puzzle, Collection& tiles) {
@@ -301,6 +439,25 @@ static void disableInteraction() {
     gSelectedIndex = kNoSelection;
 }
 
+// called by the button listeners on the Qt thread, wakes playInteractive
+static void setAction(Action action) {
+    {
+        lock_guard<mutex> guard(gActionLock);
+        gAction = action;
+    }
+    gActionChanged.notify_all();
+}
+
+const atomic<bool>* beginCancelableSolve() {
+    gCancelSolve = false;
+    if (gCancelButton) gCancelButton->setEnabled(true);
+    return &gCancelSolve;
+}
+
+void endCancelableSolve() {
+    if (gCancelButton) gCancelButton->setEnabled(false);
+}
+
 static GWindow *createWindow() {
     static const string kWindowBackground = "#dddddd";
     GWindow *win = new GWindow();
@@ -323,8 +480,12 @@ static GWindow *createWindow() {
         win->addToRegion(b, GWindow::REGION_SOUTH);
         gControls.add(b);
     };
-    addButton("Load new puzzle", []() { gAction = LOAD_NEW; });
-    addButton("Run my solver", []() { gAction = RUN_SOLVE; });
+    addButton("Load new puzzle", []() { setAction(LOAD_NEW); });
+    addButton("Run my solver", []() { setAction(RUN_SOLVE); });
+    gCancelButton = new GButton("Cancel solve"); // only enabled while a solve runs
+    gCancelButton->setActionListener([]() { gCancelSolve = true; });
+    gCancelButton->setEnabled(false);
+    win->addToRegion(gCancelButton, GWindow::REGION_SOUTH);
     return win;
 }
 
@@ -371,6 +532,15 @@ static void resetLayout(int numRows, int numCols) {
         cur.x += stackOffset.x;
         cur.y -= stackOffset.y;
     }
+    // every tile goes on the canvas once, hidden, in back-to-front stack order
+    gCanvas->clearObjects();
+    for (int i = gTileInfo.size() - 1; i >= 0; i--) {
+        gTileInfo[i].drawn = DrawnTile();
+        GCompound *c = gTileInfo[i].graphic->compound;
+        c->setVisible(false);
+        gCanvas->add(c);
+    }
+    gFrontIndex = kNoSelection;
     drawBackground(boardBounds);
     gWin->setResizable(true);
     gWin->pack();
@@ -380,54 +550,48 @@ static void resetLayout(int numRows, int numCols) {
     setConsoleSize(gWin->getWidth(), kConsoleHeight);
 }
 
-static bool readPuzzleConfigFile(string configFile, GridLocation& dim, Map<string,string>& pairs, Map<Tile, TileInfo>& tInfo) {
+// parsing is shared with the headless tools. The images named on the lines read
+// before any parse error are decoded on a thread pool, then the graphics are
+// built here in file order. An image that will not decode fails at its own line
+// through the same GImage error as a one-at-a-time load, ahead of any parse
+// error further down, so the reported reason does not depend on timing
+static bool readPuzzleConfigFile(string configFile, PuzzleConfig& config, Vector<TileInfo>& tInfo) {
+    if (configFile.empty()) return false; // dialog canceled
     string reason;
-    try {
-        if (configFile.empty()) return false; // dialog canceled
-        string dir = getHead(configFile);
-        ifstream in;
-        if (!openFile(in, configFile)) throw "No such file";
-        auto readNext = [&in]() {
-            string cur;
-            do {
-                if (!getline(in, cur)) break; trimInPlace(cur);
-            } while (cur.empty() || startsWith(cur, "#"));
-            return cur;
-        };
-        string line = readNext();
-        istringstream stream(line);
-        if (!(stream >> dim)) throw "First line does not contain dimensions, expected rNcN, found " + line;
-        for (const auto& pair: stringSplit(readNext(), " ")) {
-            Vector<string> tokens = stringSplit(pair, "=");
-            if (tokens.size() != 2) throw "Malformed pair, expected format label=opposite, found " + pair;
-            pairs[tokens[0]] = tokens[1]; // add self and inverse
-            pairs[tokens[1]] = tokens[0];
+    bool parsed = readPuzzleConfig(configFile, config, reason);
+    const Vector<string>& paths = config.imagePaths;
+    Vector<Grid<int>> pixels(paths.size());
+    Vector<int> decoded(paths.size(), 0);
+    {
+        WorkStealingPool pool;
+        for (int i = 0; i < paths.size(); i++) {
+            if (gGraphicCache.containsKey(paths[i])) continue;
+            pool.submit([&paths, &pixels, &decoded, i]() { decoded[i] = decodeTileImage(paths[i], pixels[i]); });
         }
-        string filename;
-        while ((filename = readNext()) != "") {
-            string path = dir + "/" + filename;
-            string basename = getRoot(filename);
-            if (!fileExists(path)) throw "No such image file: " + basename;
-            Vector<string> edges = stringSplit(basename, "-");
-            if (edges.size() < NUM_SIDES) throw "Tile image file name not in proper format, expected edges in N-E-S-W, found " + basename;
-            Tile tile(edges[NORTH], edges[EAST], edges[SOUTH], edges[WEST]);
-            if (tInfo.containsKey(tile)) throw "Duplicate tile listed twice: " + basename;
-            for (Direction dir = NORTH; dir <= WEST; dir++) {
-                if (!pairs.containsKey(tile.getEdge(dir))) throw "Edge label " + tile.getEdge(dir) + " of tile " + basename + " does not have matching entry in pairs";
+        pool.wait();
+    }
+    Set<TileGraphic *> used;  // by a tile of this load, and so by its place on the canvas
+    try {
+        for (int i = 0; i < paths.size(); i++) {
+            TileInfo info;
+            if (gGraphicCache.containsKey(paths[i])) {
+                TileGraphic *cached = gGraphicCache[paths[i]];
+                info.graphic = used.contains(cached) ? newTileGraphic(cached->base) : cached;
+                gImagesReused++;
+            } else if (decoded[i]) {
+                info.graphic = createTileGraphic(paths[i], pixels[i]);
+            } else {
+                info.graphic = createTileGraphic(paths[i]);
             }
-            tInfo[tile] = createTileGraphic(path, tile);
+            used.add(info.graphic);
+            info.tile = config.tiles[i];
+            tInfo.add(info); // handle is the position in file order
         }
-        if (tInfo.size() != dim.row*dim.col) throw "Mismatch in size, dimensions = " + dim.toString() + " count of tiles = " + integerToString(tInfo.size());
-        Vector<Tile> keys = tInfo.keys();
-        for (int i = 0; i < keys.size(); i++) { tInfo[keys[i]].index = i; }
-return true;
-    } catch (const string& msg) {
-        reason = msg;
-    } catch (char const* msg) {
-        reason = msg;
     } catch (ErrorException& ex) {
+        parsed = false;
         reason = ex.getMessage();
     }
+    if (parsed) return true;
     string msg = "Error reading configuration file '" + getTail(configFile) + "'\nReason: " + reason;
     GOptionPane::showMessageDialog(msg, "Error", GOptionPane::MessageType::MESSAGE_ERROR);
     cerr << msg << endl;
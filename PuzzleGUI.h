@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include "Puzzle.h"
 #include "vector.h"
 
@@ -46,3 +47,14 @@ enum Action { NONE, RUN_SOLVE, LOAD_NEW, QUIT };
  */
 Action playInteractive(Puzzle& puzzle, Vector<Tile>& tiles);
 
+/**
+ * beginCancelableSolve / endCancelableSolve
+ * -----------------------------------------
+ * Bracket a run of the solver. beginCancelableSolve enables the "Cancel solve"
+ * button and returns a flag that is set when the user presses it; pass it as
+ * SolveOptions.cancel so solve() gives up. endCancelableSolve disables the
+ * button again.
+ */
+const std::atomic<bool>* beginCancelableSolve();
+void endCancelableSolve();
+
@@ -0,0 +1,60 @@
+/*
+ * File: PuzzleGenerator.cpp
+ * -------------------------
+ * Synthetic puzzle generation. Small label alphabets make many tiles look
+ * alike and the search gets harder, large alphabets make it nearly linear.
+ */
+#include "PuzzleGenerator.h"
+#include "grid.h"
+#include "map.h"
+#include "strlib.h"
+#include <algorithm>
+#include <random>
+
+using namespace std;
+
+void generatePuzzle(int numRows, int numCols, int numLabels, unsigned seed, Puzzle& puzzle, Vector<Tile>& tiles) {
+    if (numRows < 1 || numCols < 1) error("Generated puzzle needs at least one row and column");
+    if (numLabels < 1 || 2 * numLabels >= MAX_LABELS) error("Generated puzzle label count out of range");
+    LabelScope scope;  // a fresh table, so all MAX_LABELS - 1 ids are free for the pairs
+    Map<string, string> pairs;
+    Vector<string> labels;
+    for (int i = 0; i < numLabels; i++) {
+        string upper = "A" + integerToString(i), lower = "a" + integerToString(i);
+        pairs[upper] = lower;
+        pairs[lower] = upper;
+        labels.add(upper);
+        labels.add(lower);
+    }
+    mt19937 rng(seed);
+    auto randomLabel = [&]() { return labels[uniform_int_distribution<int>(0, labels.size() - 1)(rng)]; };
+
+    // edges[loc][dir] of the solved board, each interior edge chosen once from its north/west side
+    Grid<Vector<string>> edges(numRows, numCols, Vector<string>(NUM_SIDES));
+    for (int row = 0; row < numRows; row++) {
+        for (int col = 0; col < numCols; col++) {
+            GridLocation loc(row, col);
+            edges[loc][NORTH] = (row == 0) ? randomLabel() : pairs[edges[GridLocation(row - 1, col)][SOUTH]];
+            edges[loc][WEST] = (col == 0) ? randomLabel() : pairs[edges[GridLocation(row, col - 1)][EAST]];
+            edges[loc][EAST] = randomLabel();
+            edges[loc][SOUTH] = randomLabel();
+        }
+    }
+
+    puzzle.configure(numRows, numCols, pairs);
+    tiles.clear();
+    for (const GridLocation& loc : edges.locations()) {
+        // list the edges starting from a random side, as if the tile came from a file rotated
+        const Vector<string>& e = edges[loc];
+        int turns = uniform_int_distribution<int>(0, NUM_SIDES - 1)(rng);
+        auto side = [&](Direction dir) { return e[(dir + turns) % NUM_SIDES]; };
+        tiles.add(Tile(side(NORTH), side(EAST), side(SOUTH), side(WEST)));
+    }
+    for (int i = tiles.size() - 1; i > 0; i--) {
+        int j = uniform_int_distribution<int>(0, i)(rng);
+        Tile tmp = tiles[i];
+        tiles[i] = tiles[j];
+        tiles[j] = tmp;
+    }
+    scope.commit();
+}
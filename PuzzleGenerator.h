@@ -0,0 +1,19 @@
+#pragma once
+
+#include "Puzzle.h"
+#include "Tile.h"
+#include "vector.h"
+
+/**
+ * generatePuzzle
+ * --------------
+ * Builds a solvable numRows x numCols puzzle in memory, for benchmarks and
+ * stress tests that need boards larger than the bundled configs. A solved
+ * board is laid out first: every interior edge gets a random label from
+ * numLabels complement pairs (named A0=a0, A1=a1, ...) and border edges get
+ * random labels too. The tiles are then given random rotations and shuffled.
+ * The same seed always produces the same puzzle. puzzle is configured empty
+ * and tiles receives the shuffled tiles. Like loading a config, generating
+ * starts a new label table (see LabelScope in Tile.h).
+ */
+void generatePuzzle(int numRows, int numCols, int numLabels, unsigned seed, Puzzle& puzzle, Vector<Tile>& tiles);
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+/**
+ * SnapshotQueue
+ * -------------
+ * Single-producer single-consumer hand-off of the latest snapshot with no
+ * locks, built as a triple buffer. The producer (the solver thread) fills its
+ * own back slot and publishes it, which swaps it with the middle slot, so a
+ * publish always replaces whatever the consumer has not read yet and the
+ * solver never waits for the display. The consumer (the GUI) swaps the middle
+ * slot with its own front slot, so it always gets the most recent snapshot
+ * published, never one that is frames behind the solver.
+ *
+ *     T* slot = queue.claim();  // producer
+ *     fill(*slot);
+ *     queue.publish();
+ *     T latest;
+ *     if (queue.popLatest(latest)) draw(latest);  // consumer
+ */
+template <typename T>
+class SnapshotQueue {
+public:
+    SnapshotQueue() : _middle(1), _back(0), _front(2) {}
+
+    /**
+     * @brief claim returns the producer's slot to fill. It is not seen by the
+     *        consumer until publish
+     */
+    T* claim() { return &_slots[_back]; }
+
+    /**
+     * @brief publish makes the slot returned by claim the latest snapshot, in
+     *        place of any the consumer has not taken
+     */
+    void publish() {
+        _back = _middle.exchange(_back | kFresh, std::memory_order_acq_rel) & kSlotMask;
+    }
+
+    /**
+     * @brief popLatest copies the most recent published snapshot into out
+     * @return false if nothing was published since the last pop
+     */
+    bool popLatest(T& out) {
+        if (!(_middle.load(std::memory_order_relaxed) & kFresh)) return false;
+        _front = _middle.exchange(_front, std::memory_order_acq_rel) & kSlotMask;
+        out = _slots[_front];
+        return true;
+    }
+
+private:
+    static const uint8_t kSlotMask = 0x3;
+    static const uint8_t kFresh = 0x4;  // set in _middle by publish, cleared by popLatest
+
+    T _slots[3];
+    alignas(64) std::atomic<uint8_t> _middle;  // slot last published, plus kFresh while unread
+    alignas(64) uint8_t _back;                  // slot the producer fills, only it touches this
+    alignas(64) uint8_t _front;                 // slot the consumer reads, only it touches this
+};
@@ -0,0 +1,275 @@
+/*
+ * File: SolutionCache.cpp
+ * -----------------------
+ * On-disk cache of solved boards keyed by puzzle fingerprint. Entries are
+ * small text files: the dimensions line (rNcM), then one line per cell in
+ * row-major order with the tab-separated labels the placed tile shows to the
+ * north, east, south and west.
+ */
+#include "SolutionCache.h"
+#include "PuzzleConfig.h"
+#include "error.h"
+#include "filelib.h"
+#include "map.h"
+#include "puzzle-solve.h"
+#include "strlib.h"
+#include "SimpleTest.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+using namespace std;
+
+static const string kEntryExtension = ".sol";
+static const char kSeparator = '\t';
+
+// labels of tile in the rotation that sorts first
+static string canonicalTile(Tile tile) {
+    string best;
+    for (int turn = 0; turn < NUM_SIDES; turn++) {
+        string key;
+        for (Direction dir = NORTH; dir <= WEST; dir++) {
+            key += tile.getEdge(dir);
+            key += kSeparator;
+        }
+        if (turn == 0 || key < best) best = key;
+        tile.rotate();
+    }
+    return best;
+}
+
+string puzzleFingerprint(const Puzzle& puzzle, const Vector<Tile>& tiles) {
+    if (!puzzle.hasCurrentLabels()) error("Puzzle fingerprint needs the puzzle's labels to be the current label table");
+    Vector<string> pairs, keys;
+    for (int id = 1; id < MAX_LABELS; id++) {
+        LabelId opposite = puzzle.complementOf(id);
+        if (opposite != BLANK_LABEL) pairs.add(Tile::labelString(id) + "=" + Tile::labelString(opposite));
+    }
+    for (const Tile& tile : tiles) {
+        keys.add(canonicalTile(tile));
+    }
+    sort(pairs.begin(), pairs.end());
+    sort(keys.begin(), keys.end());
+
+    // 64-bit FNV-1a over the canonical description
+    uint64_t hash = 14695981039346656037ULL;
+    auto feed = [&hash](const string& text) {
+        for (unsigned char ch : text) {
+            hash = (hash ^ ch) * 1099511628211ULL;
+        }
+        hash = (hash ^ '\n') * 1099511628211ULL;
+    };
+    feed("r" + integerToString(puzzle.numRows()) + "c" + integerToString(puzzle.numCols()));
+    for (const string& pair : pairs) feed(pair);
+    for (const string& key : keys) feed(key);
+
+    ostringstream out;
+    out << hex << setw(16) << setfill('0') << hash;
+    return out.str();
+}
+
+SolutionCache::SolutionCache(string dir) : _dir(dir) {}
+
+string SolutionCache::entryFile(const string& fingerprint) const {
+    return _dir + "/" + fingerprint + kEntryExtension;
+}
+
+// splits line at each separator, keeping empty (blank) labels
+static Vector<string> splitLabels(const string& line) {
+    Vector<string> labels;
+    size_t start = 0;
+    while (true) {
+        size_t end = line.find(kSeparator, start);
+        labels.add(line.substr(start, end - start));
+        if (end == string::npos) return labels;
+        start = end + 1;
+    }
+}
+
+bool SolutionCache::lookup(Puzzle& puzzle, Vector<Tile>& tiles, string& fingerprint) {
+    fingerprint = "";
+    if (!puzzle.hasCurrentLabels()) return false;  // its ids no longer name the labels it was loaded with
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    fingerprint = puzzleFingerprint(puzzle, tiles);
+    _stats.lookups++;
+    bool found = false;
+    ifstream in;
+    if (puzzle.isEmpty() && openFile(in, entryFile(fingerprint))) {
+        string line;
+        Vector<Vector<string>> cells;
+        bool wellFormed = getline(in, line)
+            && line == "r" + integerToString(puzzle.numRows()) + "c" + integerToString(puzzle.numCols());
+        while (wellFormed && getline(in, line)) {
+            cells.add(splitLabels(line));
+            wellFormed = cells[cells.size() - 1].size() == NUM_SIDES;
+        }
+        found = wellFormed && place(cells, puzzle, tiles);
+        if (found) _stats.hits++;
+        else _stats.rejected++;
+    }
+    _stats.lookupMs += chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    return found;
+}
+
+/*
+ * Places the cached cells on the empty board in row-major order. Each cell
+ * takes the first unused tile that shows its labels in some rotation, and only
+ * if canAdd accepts it; on any mismatch the board is cleared again.
+ */
+bool SolutionCache::place(const Vector<Vector<string>>& cells, Puzzle& puzzle, Vector<Tile>& tiles) {
+    if (cells.size() != tiles.size() || cells.size() != puzzle.numRows() * puzzle.numCols()) return false;
+    Map<string, LabelId> ids;  // only labels on the tiles can appear in a solution
+    for (const Tile& tile : tiles) {
+        for (Direction dir = NORTH; dir <= WEST; dir++) ids[tile.getEdge(dir)] = tile.getEdgeId(dir);
+    }
+    Vector<Tile> unused = tiles;
+    for (const Vector<string>& cell : cells) {
+        LabelId want[NUM_SIDES];
+        bool known = true;
+        for (Direction dir = NORTH; dir <= WEST; dir++) {
+            known = known && ids.containsKey(cell[dir]);
+            want[dir] = known ? ids[cell[dir]] : BLANK_LABEL;
+        }
+        bool placed = false;
+        for (int i = 0; known && !placed && i < unused.size(); i++) {
+            Tile tile = unused[i];
+            for (int turn = 0; !placed && turn < NUM_SIDES; turn++) {
+                placed = tile.getEdgeId(NORTH) == want[NORTH] && tile.getEdgeId(EAST) == want[EAST]
+                         && tile.getEdgeId(SOUTH) == want[SOUTH] && tile.getEdgeId(WEST) == want[WEST]
+                         && puzzle.canAdd(tile);
+                if (placed) {
+                    puzzle.add(tile);
+                    unused.remove(i);
+                } else {
+                    tile.rotate();
+                }
+            }
+        }
+        if (!placed) {
+            while (!puzzle.isEmpty()) puzzle.remove();
+            return false;
+        }
+    }
+    tiles.clear();
+    return true;
+}
+
+void SolutionCache::store(const string& fingerprint, const Puzzle& puzzle) {
+    if (!puzzle.isFull() || fingerprint.empty() || !puzzle.hasCurrentLabels()) return;
+    ostringstream out;
+    out << "r" << puzzle.numRows() << "c" << puzzle.numCols() << "\n";
+    for (int row = 0; row < puzzle.numRows(); row++) {
+        for (int col = 0; col < puzzle.numCols(); col++) {
+            Tile tile = puzzle.tileAt(GridLocation(row, col));
+            for (Direction dir = NORTH; dir <= WEST; dir++) {
+                out << tile.getEdge(dir) << (dir == WEST ? '\n' : kSeparator);
+            }
+        }
+    }
+    try {
+        if (!isDirectory(_dir)) createDirectoryPath(_dir);
+        // write aside and rename, so a reader never sees a partial entry
+        string file = entryFile(fingerprint);
+        string temp = file + ".tmp";
+        ofstream stream(temp);
+        stream << out.str();
+        stream.close();
+        if (stream && rename(temp.c_str(), file.c_str()) == 0) _stats.stores++;
+        else std::remove(temp.c_str()); // a failed write or rename leaves no stray temp file
+    } catch (ErrorException&) {
+        // no cache directory, leave the solve uncached
+    }
+}
+
+/* * * * * * Test Cases * * * * * */
+
+// a cache directory of its own for a test, emptied of entries from earlier runs
+static string emptyCacheDir(const string& name) {
+    string dir = getTempDirectory() + "/tile-solution-cache-" + name;
+    if (isDirectory(dir)) {
+        for (const string& entry : listDirectory(dir)) deleteFile(dir + "/" + entry);
+    }
+    return dir;
+}
+
+STUDENT_TEST("a puzzle whose labels a later load replaced is not fingerprinted or cached") {
+    SolutionCache cache(emptyCacheDir("scope"));
+    Puzzle puzzle, later;
+    Vector<Tile> tiles, laterTiles;
+    string reason;
+    EXPECT(loadPuzzleFile("puzzles/cola/cola.txt", puzzle, tiles, reason));
+    EXPECT(puzzle.hasCurrentLabels());
+    EXPECT(loadPuzzleFile("puzzles/turtles/turtles.txt", later, laterTiles, reason));
+    EXPECT(!puzzle.hasCurrentLabels());
+    EXPECT_ERROR(puzzleFingerprint(puzzle, tiles));
+
+    // the ids still match among themselves, so it solves, but nothing is looked up or stored
+    SolveOptions options;
+    options.cache = &cache;
+    EXPECT(solve(puzzle, tiles, options));
+    EXPECT_EQUAL(cache.stats().lookups, 0);
+    EXPECT_EQUAL(cache.stats().stores, 0);
+    string fingerprint = "unset";
+    Vector<Tile> none;
+    EXPECT(!cache.lookup(puzzle, none, fingerprint));
+    EXPECT_EQUAL(fingerprint, "");
+}
+
+STUDENT_TEST("a solved puzzle is a cache hit next time, and a tampered entry is rejected") {
+    SolutionCache cache(emptyCacheDir("hit"));
+    Puzzle puzzle;
+    Vector<Tile> tiles;
+    string reason;
+    EXPECT(loadPuzzleFile("puzzles/cola/cola.txt", puzzle, tiles, reason));
+    Puzzle solved = puzzle;
+    Vector<Tile> remaining = tiles;
+    SolveOptions options;
+    options.cache = &cache;
+    EXPECT(solve(solved, remaining, options));
+    EXPECT_EQUAL(cache.stats().stores, 1);
+
+    // tiles in another order are the same puzzle
+    Puzzle board = puzzle;
+    Vector<Tile> reversed;
+    for (int i = tiles.size() - 1; i >= 0; i--) {
+        reversed.add(tiles[i]);
+    }
+    string fingerprint;
+    EXPECT(cache.lookup(board, reversed, fingerprint));
+    EXPECT(board.isFull());
+    EXPECT(reversed.isEmpty());
+    EXPECT_EQUAL(fingerprint, puzzleFingerprint(puzzle, tiles));
+    for (int row = 0; row < board.numRows(); row++) {
+        for (int col = 0; col < board.numCols(); col++) {
+            for (Direction dir = NORTH; dir <= WEST; dir++) {
+                EXPECT_EQUAL(board.tileAt({ row, col }).getEdgeId(dir), solved.tileAt({ row, col }).getEdgeId(dir));
+            }
+        }
+    }
+
+    // the first two cells swapped are still real tiles, but canAdd turns them down
+    string file = cache.dir() + "/" + fingerprint + ".sol";
+    ifstream in(file);
+    Vector<string> lines;
+    for (string line; getline(in, line);) {
+        lines.add(line);
+    }
+    in.close();
+    swap(lines[1], lines[2]);
+    ofstream out(file, ios::trunc);
+    for (const string& line : lines) {
+        out << line << "\n";
+    }
+    out.close();
+    board = puzzle;
+    remaining = tiles;
+    EXPECT(!cache.lookup(board, remaining, fingerprint));
+    EXPECT(board.isEmpty());
+    EXPECT_EQUAL(remaining, tiles);
+    EXPECT_EQUAL(cache.stats().hits, 1);
+    EXPECT_EQUAL(cache.stats().rejected, 1);
+}
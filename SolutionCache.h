@@ -0,0 +1,82 @@
+#pragma once
+
+#include <string>
+#include "Puzzle.h"
+#include "Tile.h"
+#include "vector.h"
+
+/**
+ * puzzleFingerprint
+ * -----------------
+ * Returns a canonical fingerprint of the puzzle made of an empty board and
+ * tiles: 16 hex digits hashed from the dimensions, the label=opposite pairs
+ * and the multiset of tiles, each tile taken in the rotation whose labels
+ * sort first. Labels are hashed as strings, so the fingerprint does not
+ * depend on tile order, tile rotations or the order labels were interned in,
+ * and is stable across runs. Labels are read from the current label table,
+ * so the puzzle must have been configured under it (Puzzle::hasCurrentLabels);
+ * calling it with a puzzle from an earlier LabelScope is an error.
+ */
+std::string puzzleFingerprint(const Puzzle& puzzle, const Vector<Tile>& tiles);
+
+/**
+ * SolutionCacheStats
+ * ------------------
+ * Counters kept by a SolutionCache. A lookup that finds an entry which does
+ * not fit the puzzle counts as rejected, not as a hit. lookupMs is the total
+ * time spent in lookup, fingerprinting and verification included.
+ */
+struct SolutionCacheStats {
+    long lookups = 0;
+    long hits = 0;
+    long rejected = 0;
+    long stores = 0;
+    double lookupMs = 0;
+
+    double hitRate() const { return lookups ? double(hits) / lookups : 0; }
+    double averageLookupMs() const { return lookups ? lookupMs / lookups : 0; }
+};
+
+/**
+ * SolutionCache
+ * -------------
+ * Solved boards kept on disk, one file per puzzle fingerprint in dir, so a
+ * puzzle solved once is not searched again in later runs. An entry lists the
+ * labels each cell shows, in row-major order; nothing in it is trusted until
+ * lookup has matched every cell to an unused tile and placed it through
+ * Puzzle::canAdd. A cache object is not safe to use from concurrent solves.
+ */
+class SolutionCache {
+public:
+    /**
+     * @brief SolutionCache uses dir for its entries, creating it on the first store
+     */
+    explicit SolutionCache(std::string dir);
+
+    /**
+     * @brief lookup fills the empty board from the entry for its fingerprint
+     * @param fingerprint: set to the puzzle's fingerprint, for a later store.
+     *        Empty if the puzzle's labels are not the current ones, which
+     *        cannot be fingerprinted; such a puzzle is never a hit
+     * @return true on a hit, with every tile placed and tiles emptied; false
+     *         with puzzle and tiles unchanged if there is no usable entry
+     */
+    bool lookup(Puzzle& puzzle, Vector<Tile>& tiles, std::string& fingerprint);
+
+    /**
+     * @brief store saves the full board as the entry for fingerprint. Failing
+     *        to write is not an error, the solve just is not cached; nor is a
+     *        puzzle whose labels are not the current ones
+     */
+    void store(const std::string& fingerprint, const Puzzle& puzzle);
+
+    const SolutionCacheStats& stats() const { return _stats; }
+    const std::string& dir() const { return _dir; }
+
+private:
+    std::string entryFile(const std::string& fingerprint) const;
+    bool place(const Vector<Vector<std::string>>& cells, Puzzle& puzzle, Vector<Tile>& tiles);
+
+    std::string _dir;
+    SolutionCacheStats _stats;
+};
@@ -0,0 +1,160 @@
+/*
+ * File: SolveProfile.cpp
+ * ----------------------
+ * Counters behind the PROFILE_ hooks. The profile being recorded is kept in a
+ * thread-local pointer, so Puzzle does not need to know about it and a worker
+ * thread can record into its own profile. Allocations are counted by
+ * replacing the global operator new, which is only done in PUZZLE_PROFILE
+ * builds.
+ */
+#include "SolveProfile.h"
+#include <atomic>
+#include <cstdlib>
+#include <iomanip>
+#include <new>
+#include <sstream>
+
+using namespace std;
+
+static atomic<long> gAllocations(0);
+static thread_local SolveProfile* tCurrentProfile = nullptr;
+
+#ifdef PUZZLE_PROFILE
+void* operator new(size_t size) {
+    gAllocations.fetch_add(1, memory_order_relaxed);
+    if (void* block = malloc(size ? size : 1)) return block;
+    throw bad_alloc();
+}
+
+void operator delete(void* block) noexcept {
+    free(block);
+}
+
+void operator delete(void* block, size_t) noexcept {
+    free(block);
+}
+#endif
+
+void SolveProfile::start(int depth) {
+    _depths.clear();
+    _allocations = 0;
+    _allocationsAtStart = gAllocations.load(memory_order_relaxed);
+    _elapsedMs = 0;
+    _depth = depth;
+    _start = _last = chrono::steady_clock::now();
+    _previous = tCurrentProfile;
+    tCurrentProfile = this;
+}
+
+void SolveProfile::stop() {
+    if (kEnabled) chargeTime(_depth);
+    _elapsedMs = chrono::duration<double, milli>(chrono::steady_clock::now() - _start).count();
+    _allocations = gAllocations.load(memory_order_relaxed) - _allocationsAtStart;
+    tCurrentProfile = _previous;
+    _previous = nullptr;
+}
+
+void SolveProfile::merge(const SolveProfile& other) {
+    for (int depth = 0; depth < other._depths.size(); depth++) {
+        const Depth& from = other._depths[depth];
+        Depth& to = at(depth);
+        to.nodes += from.nodes;
+        to.edgeChecks += from.edgeChecks;
+        for (int dir = 0; dir < NUM_SIDES; dir++) {
+            to.rejections[dir] += from.rejections[dir];
+        }
+        to.backtracks += from.backtracks;
+        to.ms += from.ms;
+    }
+}
+
+SolveProfile* SolveProfile::current() {
+    return tCurrentProfile;
+}
+
+void SolveProfile::recordEdge(int depth, Direction dir, bool matched) {
+    Depth& stats = at(depth);
+    stats.edgeChecks++;
+    if (!matched) stats.rejections[dir]++;
+}
+
+void SolveProfile::recordAdd(int depth) {
+    chargeTime(depth);
+    at(depth).nodes++;
+    _depth = depth + 1;
+}
+
+void SolveProfile::recordRemove(int depth) {
+    chargeTime(depth + 1);
+    at(depth).backtracks++;
+    _depth = depth;
+}
+
+SolveProfile::Depth& SolveProfile::at(int depth) {
+    while (_depths.size() <= depth) {
+        _depths.add(Depth());
+    }
+    return _depths[depth];
+}
+
+void SolveProfile::chargeTime(int depth) {
+    chrono::steady_clock::time_point now = chrono::steady_clock::now();
+    at(depth).ms += chrono::duration<double, milli>(now - _last).count();
+    _last = now;
+}
+
+string jsonQuote(const string& text) {
+    ostringstream out;
+    out << '"';
+    for (char ch : text) {
+        switch (ch) {
+            case '"': out << "\\\""; break;
+            case '\\': out << "\\\\"; break;
+            case '\n': out << "\\n"; break;
+            case '\r': out << "\\r"; break;
+            case '\t': out << "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(ch) < 0x20) {
+                    out << "\\u" << hex << setw(4) << setfill('0') << int(ch) << dec << setfill(' ');
+                } else {
+                    out << ch;
+                }
+        }
+    }
+    out << '"';
+    return out.str();
+}
+
+string SolveProfile::toJson() const {
+    static const char* const kDirNames[NUM_SIDES] = { "north", "east", "south", "west" };
+    ostringstream out;
+    out << fixed << setprecision(3);
+    long nodes = 0, edgeChecks = 0, backtracks = 0;
+    for (const Depth& stats : _depths) {
+        nodes += stats.nodes;
+        edgeChecks += stats.edgeChecks;
+        backtracks += stats.backtracks;
+    }
+    out << "{\"instrumented\": " << (kEnabled ? "true" : "false")
+        << ", \"elapsed_ms\": " << _elapsedMs
+        << ", \"allocations\": " << _allocations
+        << ", \"nodes\": " << nodes
+        << ", \"edge_checks\": " << edgeChecks
+        << ", \"backtracks\": " << backtracks
+        << ", \"depths\": [";
+    for (int depth = 0; depth < _depths.size(); depth++) {
+        const Depth& stats = _depths[depth];
+        out << (depth ? ",\n  " : "\n  ")
+            << "{\"depth\": " << depth
+            << ", \"nodes\": " << stats.nodes
+            << ", \"edge_checks\": " << stats.edgeChecks
+            << ", \"rejections\": {";
+        for (int dir = 0; dir < NUM_SIDES; dir++) {
+            out << (dir ? ", " : "") << "\"" << kDirNames[dir] << "\": " << stats.rejections[dir];
+        }
+        out << "}, \"backtracks\": " << stats.backtracks
+            << ", \"ms\": " << stats.ms << "}";
+    }
+    out << (_depths.isEmpty() ? "]}" : "\n]}");
+    return out.str();
+}
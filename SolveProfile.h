@@ -0,0 +1,113 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include "Tile.h"
+#include "direction.h"
+#include "vector.h"
+
+/**
+ * SolveProfile
+ * ------------
+ * Optional instrumentation for the solver, filled in when SolveOptions.profile
+ * is set. The hooks in Puzzle are only compiled in when PUZZLE_PROFILE is
+ * defined (qmake CONFIG+=solver_profile); otherwise the PROFILE_ macros below
+ * expand to nothing and a profile only records the elapsed time.
+ *
+ * Statistics are kept per depth, the number of tiles on the board:
+ *   nodes       tiles added to a board holding depth tiles
+ *   edgeChecks  canMatchEdge calls made by canAdd at that depth
+ *   rejections  failed canMatchEdge calls, by direction of the neighbor
+ *   backtracks  tiles removed, leaving depth tiles on the board
+ *   ms          time spent with exactly depth tiles on the board
+ * The indexed engines skip canAdd for candidates the index already matched and
+ * the dlx engine only places tiles once it has a cover, so their edge counts
+ * and per-depth nodes are correspondingly sparse.
+ *
+ * allocations counts every operator new in the process while the profile ran,
+ * including other threads, so it covers the workers of the parallel engine.
+ */
+class SolveProfile {
+public:
+    struct Depth {
+        long nodes = 0;
+        long edgeChecks = 0;
+        long rejections[NUM_SIDES] = {};
+        long backtracks = 0;
+        double ms = 0;
+    };
+
+#ifdef PUZZLE_PROFILE
+    static const bool kEnabled = true;
+#else
+    static const bool kEnabled = false;
+#endif
+
+    /**
+     * @brief start clears the profile and makes it the one the hooks record
+     *        into on the calling thread, until stop
+     * @param depth: the number of tiles already on the board
+     */
+    void start(int depth);
+    void stop();
+
+    /**
+     * @brief merge adds the per-depth counts of other into this one, used to
+     *        gather the profiles of worker threads
+     */
+    void merge(const SolveProfile& other);
+
+    const Vector<Depth>& depths() const { return _depths; }
+    long allocations() const { return _allocations; }
+    double elapsedMs() const { return _elapsedMs; }
+
+    /**
+     * @brief toJson returns the profile as a JSON object with the totals and a
+     *        "depths" array indexed by depth
+     */
+    std::string toJson() const;
+
+    /**
+     * @brief current returns the profile started on this thread, nullptr if none
+     */
+    static SolveProfile* current();
+
+    // hooks, called through the PROFILE_ macros
+    void recordEdge(int depth, Direction dir, bool matched);
+    void recordAdd(int depth);
+    void recordRemove(int depth);
+
+private:
+    Depth& at(int depth);
+    void chargeTime(int depth);  // time since the last add or remove goes to depth
+
+    Vector<Depth> _depths;
+    long _allocations = 0;
+    long _allocationsAtStart = 0;
+    double _elapsedMs = 0;
+    int _depth = 0;  // tiles on the board as of the last add or remove
+    std::chrono::steady_clock::time_point _start, _last;
+    SolveProfile* _previous = nullptr;
+};
+
+/**
+ * jsonQuote
+ * ---------
+ * Returns text as a JSON string literal, quoted, with quotes, backslashes and
+ * control characters escaped. For the file paths and names written next to a
+ * profile by the tools.
+ */
+std::string jsonQuote(const std::string& text);
+
+#ifdef PUZZLE_PROFILE
+#define PROFILE_EDGE(depth, dir, matched) \
+    do { if (SolveProfile* profile_ = SolveProfile::current()) profile_->recordEdge(depth, dir, matched); } while (0)
+#define PROFILE_ADD(depth) \
+    do { if (SolveProfile* profile_ = SolveProfile::current()) profile_->recordAdd(depth); } while (0)
+#define PROFILE_REMOVE(depth) \
+    do { if (SolveProfile* profile_ = SolveProfile::current()) profile_->recordRemove(depth); } while (0)
+#else
+#define PROFILE_EDGE(depth, dir, matched) ((void) 0)
+#define PROFILE_ADD(depth) ((void) 0)
+#define PROFILE_REMOVE(depth) ((void) 0)
+#endif
@@ -3,64 +3,115 @@
  */
 
 #include "Tile.h"
+#include "map.h"
+#include "strlib.h"
+#include "vector.h"
 #include "SimpleTest.h"
+#include <type_traits>
 
 using namespace std;
 
-Tile::Tile(string n, string e, string s, string w) {
-    _id = n + e + s + w;    // sets an id for internal use, do not change this line!
+static_assert(is_trivially_copyable<Tile>::value, "Tile must stay a plain value for the solver");
+
+/* The current label table is shared by every tile of the puzzle being worked
+ * on. Index into labels is the label id, entry 0 is the blank label so that a
+ * zero-filled Tile is a blank tile.
+ */
+static long gLastTableId = 0;
 
-    _north = n;
-    _east = e;
-    _south = s;
-    _west = w;
+struct InternedLabels {
+    Vector<string> labels = Vector<string>(1, "");
+    Map<string, LabelId> ids;
+    long tableId = ++gLastTableId;  // new for every table, moves with it when scopes swap them
+};
+
+static InternedLabels& currentLabels() {
+    static InternedLabels table;
+    return table;
 }
 
-string Tile::getEdge(Direction dir) const {
-    if (dir == NORTH)
-    {
-        return _north;
-    }
-    else if (dir == EAST)
-    {
-        return _east;
-    }
-    else if (dir == SOUTH)
-    {
-        return _south;
+LabelScope::LabelScope() : _saved(new InternedLabels), _committed(false) {
+    swap(*_saved, currentLabels());
+}
+
+LabelScope::~LabelScope() {
+    if (!_committed) swap(*_saved, currentLabels());
+    delete _saved;
+}
+
+LabelId Tile::internLabel(const string& label) {
+    if (label.empty()) return BLANK_LABEL;
+    InternedLabels& table = currentLabels();
+    if (!table.ids.containsKey(label)) {
+        if (table.labels.size() == MAX_LABELS) error("Too many distinct edge labels, at most " + integerToString(MAX_LABELS - 1) + " are supported");
+        table.ids[label] = table.labels.size();
+        table.labels.add(label);
     }
-    return _west;
+    return table.ids[label];
+}
+
+const string& Tile::labelString(LabelId id) {
+    return currentLabels().labels[id];
 }
 
-void Tile::rotate() {
-    string n = _north;
-    string e = _east;
-    string s = _south;
-    string w = _west;
+long Tile::labelTableId() {
+    return currentLabels().tableId;
+}
 
-    _north = w;
-    _east = n;
-    _south = e;
-    _west = s;
+Tile::Tile(string n, string e, string s, string w) {
+    _edges[NORTH] = internLabel(n);
+    _edges[EAST] = internLabel(e);
+    _edges[SOUTH] = internLabel(s);
+    _edges[WEST] = internLabel(w);
+    _rotation = 0;
 }
 
+Tile::Tile(LabelId n, LabelId e, LabelId s, LabelId w) : _edges{n, e, s, w}, _rotation(0) {}
+
+const string& Tile::getEdge(Direction dir) const {
+    return labelString(getEdgeId(dir));
+}
 
-Tile::Tile() : Tile("","","","") {}    // default constructor creates blank tile
+Tile::Tile() : _edges{BLANK_LABEL, BLANK_LABEL, BLANK_LABEL, BLANK_LABEL}, _rotation(0) {}    // default constructor creates blank tile
 
 bool Tile::isBlank() const {
-    return (_north == "" && _east == "" && _south == "" && _west == "");
+    return (_edges[NORTH] == BLANK_LABEL && _edges[EAST] == BLANK_LABEL
+            && _edges[SOUTH] == BLANK_LABEL && _edges[WEST] == BLANK_LABEL);
 }
 
 string Tile::displayTileStr() const{
     string s;
-    s += "  " + _north + "\n";
-    s += _west;
-    s += "   " + _east + "\n";
-    s += "  " + _south + "\n";
+    s += "  " + getEdge(NORTH) + "\n";
+    s += getEdge(WEST);
+    s += "   " + getEdge(EAST) + "\n";
+    s += "  " + getEdge(SOUTH) + "\n";
     return s;
 }
 
 string Tile::toString() const {
-    return _north + "-" + _east + "-" + _south + "-" + _west;
+    return getEdge(NORTH) + "-" + getEdge(EAST) + "-" + getEdge(SOUTH) + "-" + getEdge(WEST);
+}
+
+// identity ignores rotation, same as the string id this replaced
+bool operator< (const Tile& lhs, const Tile& rhs) {
+    for (int i = 0; i < NUM_SIDES; i++) {
+        if (lhs._edges[i] != rhs._edges[i]) return lhs._edges[i] < rhs._edges[i];
+    }
+    return false;
+}
+
+bool operator== (const Tile& lhs, const Tile& rhs) {
+    for (int i = 0; i < NUM_SIDES; i++) {
+        if (lhs._edges[i] != rhs._edges[i]) return false;
+    }
+    return true;
 }
 
+// agrees with operator==, so a tile finds the same HashMap entry in any rotation
+int hashCode(const Tile& tile) {
+    uint32_t code = 0;
+    for (int i = 0; i < NUM_SIDES; i++) {
+        code = (code << 8) | tile._edges[i];
+    }
+    return int(code);
+}
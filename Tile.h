@@ -1,15 +1,30 @@
 #pragma once
 
+#include <cstdint>
 #include "direction.h" // for NORTH, EAST, SOUTH, WEST
 
 #define NUM_SIDES 4
+#define MAX_LABELS 256
 
+/* type LabelId
+ * Edge labels are interned into small integer ids the first time they are
+ * seen, so the solver compares integers instead of strings. Id 0 is reserved
+ * for the empty label of a blank tile.
+ */
+typedef uint8_t LabelId;
+static const LabelId BLANK_LABEL = 0;
+
+/* class Tile
+ * A Tile is a plain value (four label ids plus a rotation count) and copying
+ * one never allocates. The original label strings remain available through
+ * getEdge and the static label table.
+ */
 class Tile {
 public:
     /* constructor Tile (overloaded)
      * The constructor is passed four strings that indicate the labels
-     * for the tile's edges. These strings are aassigned to the
-     * private member variables of the newly constructed Tile object.
+     * for the tile's edges. Each string is interned in the label table
+     * and the resulting ids are stored in the newly constructed Tile object.
      *
      * @param north The string label for the top edge of the tile
      * @param east The string label for the right edge of the tile
@@ -18,6 +33,12 @@ public:
      */
     Tile(std::string north, std::string east, std::string south, std::string west);
 
+    /* constructor Tile (overloaded)
+     * Constructs a tile from label ids already in the label table, as
+     * read back from a compiled puzzle. No strings are touched.
+     */
+    Tile(LabelId north, LabelId east, LabelId south, LabelId west);
+
     /* member function getEdge
      * Return the string label for the specified edge
      *
@@ -25,15 +46,31 @@ public:
      *
      * @return The string label for the requested edge
      */
-    std::string getEdge(Direction dir) const;
+    const std::string& getEdge(Direction dir) const;
+
+    /* member function getEdgeId
+     * Return the interned label id for the specified edge. This is the
+     * accessor used by the solver, it is a table lookup and never allocates.
+     *
+     * @param dir The desired edge: NORTH, EAST, SOUTH, or WEST
+     *
+     * @return The label id for the requested edge
+     */
+    LabelId getEdgeId(Direction dir) const { return _edges[(dir + NUM_SIDES - _rotation) % NUM_SIDES]; }
+
+    /* member function getRotation
+     * Return how many quarter turns clockwise the tile has been rotated
+     * from the orientation it was constructed with, in the range 0-3.
+     */
+    int getRotation() const { return _rotation; }
 
     /* member function rotate()
-     * Updates the private member variables for tile edges to
-     * simulate a quarter turn in the clockwise direction. The edge
-     * label that was previously stored for west has moved to north,
-     * what was south has moved to west, and so on.
+     * Advances the rotation count to simulate a quarter turn in the
+     * clockwise direction. The edge label that was previously reported
+     * for west is now reported for north, what was south is now west,
+     * and so on.
      */
-    void rotate();
+    void rotate() { _rotation = (_rotation + 1) % NUM_SIDES; }
 
     /* constructor Tile (default)
      * The default constructor. Constructs a Tile with empty edges (blank).
@@ -76,18 +113,82 @@ public:
      *
      * @return The function returns out
      */
-    friend bool operator< (const Tile& lhs, const Tile& rhs) { return lhs._id < rhs._id; }
-    friend bool operator== (const Tile& lhs, const Tile& rhs) { return lhs._id == rhs._id; }
+    friend bool operator< (const Tile& lhs, const Tile& rhs);
+    friend bool operator== (const Tile& lhs, const Tile& rhs);
+    friend int hashCode(const Tile& tile);
     friend std::ostream &operator<<(std::ostream &out, const Tile &tile) { return out << tile.toString(); }
 
+    /* static function internLabel
+     * Returns the id for the given label string, assigning the next free id
+     * if the label has not been seen before. Labels are interned while a
+     * puzzle is loaded, into the table of the current LabelScope; the table
+     * is not safe to grow concurrently.
+     *
+     * @param label The string label of an edge
+     *
+     * @return The id that stands for label
+     */
+    static LabelId internLabel(const std::string& label);
+
+    /* static function labelString
+     * Returns the original string for an interned label id.
+     *
+     * @param id A label id previously returned by internLabel
+     *
+     * @return The string label that id stands for
+     */
+    static const std::string& labelString(LabelId id);
+
+    /* static function labelTableId
+     * Returns a number that identifies the current label table and no other
+     * table of the run. A Puzzle records it when configured, so code that turns
+     * its ids back into strings can tell whether they still mean the same.
+     *
+     * @return The id of the current label table
+     */
+    static long labelTableId();
+
 private:
-    /* member variables _north, _east, _south, and _west
-     * each is the string label for the corresponding edge
+    /* member variable _edges
+     * the label ids of the north, east, south and west edges in the
+     * orientation the tile was constructed with. The identity of a tile
+     * (for comparison in Set/Map) is this array, independent of rotation.
      */
-    std::string _north;
-    std::string _east;
-    std::string _south;
-    std::string _west;
+    LabelId _edges[NUM_SIDES];
 
-    std::string _id; // unique identifier required for comparison (Set/Map)
+    /* member variable _rotation
+     * number of quarter turns clockwise applied since construction, 0-3
+     */
+    uint8_t _rotation;
+};
+
+/* class LabelScope
+ * Label ids are scoped to a puzzle: each puzzle that is loaded or generated
+ * interns its labels into a table of its own, so the MAX_LABELS - 1 limit
+ * applies per puzzle and not to the whole run. Constructing a LabelScope sets
+ * the current table aside and starts an empty one. commit() keeps the new
+ * table, which replaces the old for good; if the scope ends without a commit,
+ * for instance because the load failed, the old table is put back and the
+ * tiles of the puzzle loaded before stay readable. Scopes nest, an inner
+ * commit only hands its table to the enclosing scope.
+ *
+ * Tiles and puzzles from before a committed scope keep matching correctly
+ * among themselves, but their getEdge strings are no longer meaningful.
+ */
+class LabelScope {
+public:
+    LabelScope();
+    ~LabelScope();
+
+    /* member function commit
+     * Keeps the labels interned since the scope began as the current table.
+     */
+    void commit() { _committed = true; }
+
+    LabelScope(const LabelScope&) = delete;
+    LabelScope& operator=(const LabelScope&) = delete;
+
+private:
+    struct InternedLabels* _saved;
+    bool _committed;
 };
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+
+#define MAX_TILES 256
+
+/**
+ * TileBitset
+ * ----------
+ * Fixed-capacity set of tile ids in the range 0 to MAX_TILES-1, one bit per
+ * tile. Adding and removing an id is a single bit operation with no memory
+ * traffic, which is what the solver needs for its pool of unused tiles.
+ * Iterate by copying out a word and peeling off its lowest set bit:
+ *
+ *     for (int w = 0; w < TileBitset::kNumWords; w++) {
+ *         for (uint64_t bits = set.word(w); bits; bits &= bits - 1) {
+ *             int id = w * 64 + TileBitset::lowestBit(bits);
+ *             ...
+ */
+class TileBitset {
+public:
+    static const int kNumWords = MAX_TILES / 64;
+
+    TileBitset() : _words{} {}
+
+    void add(int id)            { _words[id >> 6] |= bitFor(id); }
+    void remove(int id)         { _words[id >> 6] &= ~bitFor(id); }
+    bool contains(int id) const { return (_words[id >> 6] & bitFor(id)) != 0; }
+    uint64_t word(int w) const  { return _words[w]; }
+    void setWord(int w, uint64_t bits) { _words[w] = bits; }
+
+    bool isEmpty() const {
+        for (int w = 0; w < kNumWords; w++) {
+            if (_words[w]) return false;
+        }
+        return true;
+    }
+
+    int size() const {
+        int count = 0;
+        for (int w = 0; w < kNumWords; w++) count += __builtin_popcountll(_words[w]);
+        return count;
+    }
+
+    bool operator==(const TileBitset& other) const {
+        for (int w = 0; w < kNumWords; w++) {
+            if (_words[w] != other._words[w]) return false;
+        }
+        return true;
+    }
+
+    // index of the lowest set bit of a nonzero word
+    static int lowestBit(uint64_t bits) { return __builtin_ctzll(bits); }
+
+private:
+    static uint64_t bitFor(int id) { return uint64_t(1) << (id & 63); }
+
+    uint64_t _words[kNumWords];
+};
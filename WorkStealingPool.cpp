@@ -0,0 +1,131 @@
+/*
+ * File: WorkStealingPool.cpp
+ * --------------------------
+ * Each deque has its own lock, so owners and thieves only contend when they
+ * touch the same deque. The pool-wide lock only guards the pending count and
+ * the sleep/wake of idle workers.
+ */
+#include "WorkStealingPool.h"
+#include "SimpleTest.h"
+#include <atomic>
+
+using namespace std;
+
+// which worker of which pool the thread is, so pools nested in another's tasks keep apart
+static thread_local const WorkStealingPool* tCurrentPool = nullptr;
+static thread_local int tCurrentWorker = -1;
+
+WorkStealingPool::WorkStealingPool(int numThreads) : _pending(0), _queued(0), _nextWorker(0), _stopping(false) {
+    if (numThreads <= 0) numThreads = max(1u, thread::hardware_concurrency());
+    for (int i = 0; i < numThreads; i++) {
+        _workers.emplace_back(new Worker());
+    }
+    for (int i = 0; i < numThreads; i++) {
+        _threads.emplace_back(&WorkStealingPool::run, this, i);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    wait();
+    {
+        lock_guard<mutex> guard(_lock);
+        _stopping = true;
+    }
+    _hasWork.notify_all();
+    for (thread& t : _threads) t.join();
+}
+
+int WorkStealingPool::currentWorker() const {
+    return (tCurrentPool == this) ? tCurrentWorker : -1;
+}
+
+void WorkStealingPool::submit(Task task) {
+    int target = currentWorker();
+    {
+        lock_guard<mutex> guard(_lock);
+        _pending++;
+        _queued++;
+        if (target < 0) target = _nextWorker++ % _workers.size();
+    }
+    {
+        lock_guard<mutex> guard(_workers[target]->lock);
+        _workers[target]->tasks.push_back(std::move(task));
+    }
+    _hasWork.notify_one();
+}
+
+void WorkStealingPool::wait() {
+    unique_lock<mutex> guard(_lock);
+    _allDone.wait(guard, [this] { return _pending == 0; });
+}
+
+// own deque newest-first, then steal oldest-first from the others
+bool WorkStealingPool::takeTask(int self, Task& task) {
+    {
+        Worker& mine = *_workers[self];
+        lock_guard<mutex> guard(mine.lock);
+        if (!mine.tasks.empty()) {
+            task = std::move(mine.tasks.back());
+            mine.tasks.pop_back();
+            return true;
+        }
+    }
+    for (size_t i = 1; i < _workers.size(); i++) {
+        Worker& victim = *_workers[(self + i) % _workers.size()];
+        lock_guard<mutex> guard(victim.lock);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::run(int self) {
+    tCurrentPool = this;
+    tCurrentWorker = self;
+    while (true) {
+        Task task;
+        if (takeTask(self, task)) {
+            {
+                lock_guard<mutex> guard(_lock);
+                _queued--;
+            }
+            task();
+            lock_guard<mutex> guard(_lock);
+            if (--_pending == 0) _allDone.notify_all();
+            continue;
+        }
+        // _queued is only changed under _lock, so a submit cannot slip past this wait
+        unique_lock<mutex> guard(_lock);
+        _hasWork.wait(guard, [this] { return _stopping || _queued > 0; });
+        if (_stopping && _queued == 0) return;
+    }
+}
+
+/* * * * * * Test Cases * * * * * */
+
+STUDENT_TEST("a pool started from another pool's task numbers only its own workers") {
+    WorkStealingPool outer(4);
+    atomic<int> outOfRange(0), seenFromOutside(0);
+    for (int task = 0; task < 8; task++) {
+        outer.submit([&]() {
+            WorkStealingPool inner(2);
+            if (inner.currentWorker() != -1) seenFromOutside++;
+            for (int sub = 0; sub < 4; sub++) {
+                inner.submit([&]() {
+                    int worker = inner.currentWorker();
+                    if (worker < 0 || worker >= inner.numThreads()) outOfRange++;
+                    if (outer.currentWorker() != -1) seenFromOutside++;
+                });
+            }
+            inner.wait();
+            if (outer.currentWorker() < 0 || outer.currentWorker() >= outer.numThreads()) outOfRange++;
+        });
+    }
+    outer.wait();
+    EXPECT_EQUAL(outOfRange.load(), 0);
+    EXPECT_EQUAL(seenFromOutside.load(), 0);
+    EXPECT_EQUAL(outer.currentWorker(), -1);
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * WorkStealingPool
+ * ----------------
+ * A fixed set of worker threads, each with its own deque of tasks. A worker
+ * pops from the back of its own deque and, when that is empty, steals from
+ * the front of another worker's deque, so uneven subtrees even out on their
+ * own. Tasks submitted from inside a worker go on that worker's deque.
+ */
+class WorkStealingPool {
+public:
+    typedef std::function<void()> Task;
+
+    /**
+     * @brief WorkStealingPool starts numThreads workers, or one per hardware
+     *        thread if numThreads is 0
+     */
+    explicit WorkStealingPool(int numThreads = 0);
+
+    /**
+     * @brief ~WorkStealingPool waits for outstanding tasks, then joins the workers
+     */
+    ~WorkStealingPool();
+
+    /**
+     * @brief submit queues a task. From outside the pool tasks are dealt to the
+     *        workers round-robin
+     */
+    void submit(Task task);
+
+    /**
+     * @brief wait blocks until every submitted task has finished running
+     */
+    void wait();
+
+    int numThreads() const { return (int)_threads.size(); }
+
+    /**
+     * @brief currentWorker returns the index of this pool's worker running the
+     *        calling thread, or -1 if the thread is not one of this pool's
+     *        workers, such as the caller or a worker of another pool
+     */
+    int currentWorker() const;
+
+private:
+    struct Worker {
+        std::mutex lock;
+        std::deque<Task> tasks;
+    };
+
+    bool takeTask(int self, Task& task);
+    void run(int self);
+
+    std::vector<std::unique_ptr<Worker>> _workers;
+    std::vector<std::thread> _threads;
+    std::mutex _lock;
+    std::condition_variable _hasWork;
+    std::condition_variable _allDone;
+    int _pending;       // tasks queued or running
+    int _queued;        // tasks sitting in some deque
+    int _nextWorker;    // round-robin target for outside submits
+    bool _stopping;
+};
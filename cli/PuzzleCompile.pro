@@ -0,0 +1,30 @@
+###############################################################################
+# Project file for the puzzle compiler
+#
+#   build console program puzzle-compile from the GUI-free solver sources in
+#   ../solver.pri, using the installed cs106 library for its collections
+###############################################################################
+
+TEMPLATE  = app
+TARGET    = puzzle-compile
+QT += core gui widgets network
+CONFIG  += console silent
+CONFIG  -= app_bundle depend_includepath
+CONFIG  += c++17
+
+# Library installed into per-user writable data location from QtStandardPaths
+win32|win64 { QTP_EXE = qtpaths.exe } else { QTP_EXE = qtpaths }
+USER_DATA_DIR = $$system($$[QT_INSTALL_BINS]/$$QTP_EXE --writable-path GenericDataLocation)
+
+SPL_DIR = $${USER_DATA_DIR}/cs106
+LIBS += -lcs106 -lpthread
+QMAKE_LFLAGS = -L$$shell_quote($${SPL_DIR}/lib)
+INCLUDEPATH += "$${SPL_DIR}/include"
+
+# deploy next to the GUI executable so relative puzzles/ paths work the same
+DESTDIR = $$PWD/..
+
+# no main=qMain rename here, the tool has a plain console main()
+include(../solver.pri)
+
+SOURCES += $$PWD/puzzle-compile.cpp
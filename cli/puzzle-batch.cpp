@@ -0,0 +1,153 @@
+/*
+ * File: puzzle-batch.cpp
+ * ----------------------
+ * Headless batch solver. Solves each puzzle configuration file named on the
+ * command line with no rendering and prints each solution and its timing.
+ * A directory argument stands for every config found beneath it, loaded from
+ * the compiled .tpb beside it when there is one (see puzzle-compile); a .tpb
+ * can also be named directly.
+ *
+ *     puzzle-batch [-q] [-c|-C|-a ms] [-e engine] [-t threads] [-p profile.json] [-k cachedir] puzzles/cola/cola.txt puzzles/dogs ...
+ *
+ * -q prints only the one-line result for each puzzle, not the solved board.
+ * -e selects the solver engine by name (see engineName), default vector.
+ * -t sets the worker count of the parallel engine, default one per core.
+ * -c counts every solution instead of stopping at the first, reporting raw
+ *    and unique (up to whole-board rotation) counts. -C does the same without
+ *    symmetry breaking, to cross-check the pinned count.
+ * -p writes a SolveProfile for each solve to the file as a JSON array. The
+ *    per-depth counters are only filled in builds with CONFIG+=solver_profile.
+ * -k checks the solution cache in cachedir before searching and stores new
+ *    solutions there, then reports the cache hit rate and lookup latency.
+ * -a runs the local search (see LocalSearch.h) for ms milliseconds instead of
+ *    solving, reporting how many interior edges of the best board match and
+ *    printing each improvement as it is found. -t sets its thread count. Boards
+ *    left with unmatched edges are counted as best effort, not as unsolvable.
+ */
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include "LocalSearch.h"
+#include "Puzzle.h"
+#include "PuzzleConfig.h"
+#include "puzzle-solve.h"
+#include "strlib.h"
+#include "vector.h"
+
+using namespace std;
+
+int main(int argc, char* argv[]) {
+    bool quiet = false;
+    bool count = false, breakSymmetry = true;
+    double annealMs = 0;
+    SolveOptions options;
+    string profileFile, cacheDir;
+    Vector<string> files;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "-q") quiet = true;
+        else if (arg == "-c") count = true;
+        else if (arg == "-C") count = true, breakSymmetry = false;
+        else if (arg == "-e" && i + 1 < argc) {
+            if (!engineForName(argv[++i], options.engine)) {
+                cerr << "Unknown engine " << argv[i] << endl;
+                return 2;
+            }
+        }
+        else if (arg == "-t" && i + 1 < argc) options.threads = stringToInteger(argv[++i]);
+        else if (arg == "-p" && i + 1 < argc) profileFile = argv[++i];
+        else if (arg == "-k" && i + 1 < argc) cacheDir = argv[++i];
+        else if (arg == "-a" && i + 1 < argc) annealMs = stringToReal(argv[++i]);
+        else gatherPuzzleFiles(arg, files, true);
+    }
+    if (files.isEmpty()) {
+        cerr << "usage: " << argv[0] << " [-q] [-c|-C|-a ms] [-e engine] [-t threads] [-p profile.json] [-k cachedir] config.txt|directory ..." << endl;
+        return 2;
+    }
+
+    int numSolved = 0, numUnsolvable = 0, numBestEffort = 0, numErrors = 0;
+    double totalMs = 0;
+    Vector<string> profiles;
+    SolutionCache cache(cacheDir);
+    if (!cacheDir.empty()) options.cache = &cache;
+    cout << fixed << setprecision(3);
+    for (const string& file : files) {
+        Puzzle puzzle;
+        Vector<Tile> tiles;
+        string reason;
+        if (!loadPuzzleFile(file, puzzle, tiles, reason)) {
+            cout << file << ": error: " << reason << endl;
+            numErrors++;
+            continue;
+        }
+        if (count) {
+            SolutionCount result = countSolutions(puzzle, tiles, breakSymmetry);
+            totalMs += result.elapsedMs;
+            cout << file << ": " << result.raw << " solutions, " << result.unique << " unique up to "
+                 << result.symmetry << " board rotations, " << result.nodes << " nodes, " << result.elapsedMs << " ms" << endl;
+            if (result.raw > 0) numSolved++;
+            else numUnsolvable++;
+            continue;
+        }
+        if (annealMs > 0) {
+            AnnealOptions annealOptions;
+            annealOptions.timeLimitMs = annealMs;
+            annealOptions.threads = options.threads;
+            if (!quiet) {
+                annealOptions.observer = [](const Puzzle&, const AnnealResult& best) {
+                    cout << "  " << best.matched << " of " << best.totalEdges << " edges at " << best.elapsedMs << " ms" << endl;
+                };
+            }
+            AnnealResult result = anneal(puzzle, tiles, annealOptions);
+            totalMs += result.elapsedMs;
+            cout << file << ": " << result.matched << " of " << result.totalEdges << " edges matched in "
+                 << result.elapsedMs << " ms, " << result.moves << " moves, " << result.exchanges << " exchanges" << endl;
+            if (result.matched == result.totalEdges) numSolved++;
+            else numBestEffort++; // the search gave up, which does not show there is no solution
+            if (!quiet) puzzle.print();
+            continue;
+        }
+        SolveStats stats;
+        SolveProfile profile;
+        options.stats = &stats;
+        options.profile = profileFile.empty() ? nullptr : &profile;
+        auto start = chrono::steady_clock::now();
+        bool success = solve(puzzle, tiles, options);
+        double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        totalMs += ms;
+        cout << file << ": " << (success ? "solved" : "no solution") << " in " << ms << " ms, "
+             << stats.nodes << " nodes, " << stats.probes << " probes";
+        if (!success && !checkFeasible(puzzle, tiles, reason)) cout << " (" << reason << ")";
+        cout << endl;
+        if (options.profile) {
+            profiles.add("{\"file\": " + jsonQuote(file) + ", \"engine\": " + jsonQuote(engineName(options.engine))
+                         + ", \"solved\": " + (success ? "true" : "false") + ", \"profile\": " + profile.toJson() + "}");
+        }
+        if (success) {
+            numSolved++;
+            if (!quiet) puzzle.print();
+        } else {
+            numUnsolvable++;
+        }
+    }
+    cout << files.size() << " configs, " << numSolved << " solved, " << numUnsolvable << " with no solution, ";
+    if (annealMs > 0) cout << numBestEffort << " best effort, ";
+    cout << numErrors << " not loaded, " << totalMs << " ms solving" << endl;
+    if (options.cache) {
+        const SolutionCacheStats& stats = cache.stats();
+        cout << "cache: " << stats.hits << " of " << stats.lookups << " lookups hit (" << 100 * stats.hitRate() << "%), "
+             << stats.rejected << " rejected, " << stats.stores << " stored, " << stats.averageLookupMs() << " ms per lookup" << endl;
+    }
+    if (!profileFile.empty()) {
+        ofstream out(profileFile);
+        out << "[" << endl;
+        for (int i = 0; i < profiles.size(); i++) {
+            out << profiles[i] << (i + 1 < profiles.size() ? "," : "") << endl;
+        }
+        out << "]" << endl;
+        if (!out) cerr << "Could not write " << profileFile << endl;
+    }
+    return numErrors == 0 ? 0 : 1;
+}
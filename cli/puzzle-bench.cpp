@@ -0,0 +1,336 @@
+/*
+ * File: puzzle-bench.cpp
+ * ----------------------
+ * Headless benchmark for the solver engines. Each instance is loaded once,
+ * then solved repeatedly from a fresh copy of the board.
+ *
+ *     puzzle-bench [-r repeats] [-t maxThreads] [-n tableKb] [-g RxC[:labels[:seed]]] ... [config.txt ...]
+ *     puzzle-bench -s [-e engine] ... [-l labels,...] [-b budgetMs] [puzzleDir]
+ *
+ * By default every sequential engine is run on each instance and the best and
+ * mean time per solve are reported with the node and probe counts. With -t the
+ * parallel engine is run instead with 1 to maxThreads workers and the speedup
+ * over one worker is reported; adding -n gives each worker a nogood table of
+ * tableKb kilobytes. With -n alone the indexed and iterative engines are run
+ * without and with a nogood table of tableKb kilobytes, reporting the table's
+ * hit rate and the reduction in nodes. -g adds a synthetic instance from
+ * generatePuzzle, e.g. -g 6x6:4 for a 6x6 board with 4 label pairs. With no
+ * configs and no -g it runs the tens, dogs and ocean puzzles.
+ *
+ * -s runs the regression suite instead: every config below puzzleDir (default
+ * puzzles, skipping the malformed folder), then synthetic boards from 3x3 to
+ * 8x8 for each label count (default 3,6), each solved once per engine (default
+ * indexed). Every run is cut off after budgetMs (default 5000). Results are
+ * tab-separated, one line per run, for diffing between versions:
+ *
+ *     instance  engine  status  nodes  probes  first_ms  nodes_per_sec  peak_kb
+ *
+ * status is solved, unsolvable or timeout. first_ms is the time to the first
+ * solution, which is where solve() stops. peak_kb is the peak resident size
+ * of the process so far, so it only grows from one line to the next.
+ */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+#include "Puzzle.h"
+#include "PuzzleConfig.h"
+#include "PuzzleGenerator.h"
+#include "puzzle-solve.h"
+#include "filelib.h"
+#include "strlib.h"
+#include "vector.h"
+
+using namespace std;
+
+static const int kDefaultRepeats = 200;
+static const int kDefaultLabels = 4;
+static const int kDefaultBudgetMs = 5000;
+static const int kSuiteMinSize = 3;
+static const int kSuiteMaxSize = 8;
+
+struct Instance {
+    string name;
+    string source;  // config file, or RxC[:labels[:seed]] when synthetic
+    bool synthetic = false;
+    Puzzle puzzle;
+    Vector<Tile> tiles;
+};
+
+// parses RxC[:labels[:seed]]
+static bool parseSpec(string spec, int& rows, int& cols, int& labels, unsigned& seed) {
+    Vector<string> parts = stringSplit(spec, ":");
+    Vector<string> dims = stringSplit(parts[0], "x");
+    if (dims.size() != 2 || !stringIsInteger(dims[0]) || !stringIsInteger(dims[1])) return false;
+    rows = stringToInteger(dims[0]);
+    cols = stringToInteger(dims[1]);
+    labels = (parts.size() > 1) ? stringToInteger(parts[1]) : kDefaultLabels;
+    seed = (parts.size() > 2) ? stringToInteger(parts[2]) : 1;
+    return true;
+}
+
+// parses RxC[:labels[:seed]] and generates the instance
+static bool generateInstance(string spec, Instance& instance) {
+    int rows, cols, labels;
+    unsigned seed;
+    if (!parseSpec(spec, rows, cols, labels, seed)) return false;
+    generatePuzzle(rows, cols, labels, seed, instance.puzzle, instance.tiles);
+    instance.name = "synthetic-" + spec;
+    return true;
+}
+
+/*
+ * Label ids belong to the puzzle loaded or generated last (see LabelScope), so
+ * the instances named on the command line are only loaded one at a time, just
+ * before they are run.
+ */
+static bool loadInstance(Instance& instance) {
+    if (instance.synthetic) return generateInstance(instance.source, instance);
+    string reason;
+    if (!loadPuzzleFile(instance.source, instance.puzzle, instance.tiles, reason)) {
+        cerr << instance.source << ": error: " << reason << endl;
+        return false;
+    }
+    return true;
+}
+
+// best and mean milliseconds over repeats solves of a fresh copy of instance
+static void timeSolve(const Instance& instance, SolveOptions options, int repeats,
+                      double& best, double& mean, SolveStats& stats) {
+    double total = 0;
+    for (int r = 0; r < repeats; r++) {
+        Puzzle puzzle = instance.puzzle;
+        Vector<Tile> tiles = instance.tiles;
+        stats = SolveStats();
+        options.stats = &stats;
+        auto start = chrono::steady_clock::now();
+        solve(puzzle, tiles, options);
+        double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        best = (r == 0) ? ms : min(best, ms);
+        total += ms;
+    }
+    mean = total / repeats;
+}
+
+static void compareEngines(const Instance& instance, int repeats) {
+    for (SolveEngine engine : { ENGINE_VECTOR, ENGINE_BITSET, ENGINE_INDEXED, ENGINE_DLX, ENGINE_MRV, ENGINE_ITERATIVE, ENGINE_FIXED }) {
+        SolveOptions options;
+        options.engine = engine;
+        SolveStats stats;
+        double best, mean;
+        timeSolve(instance, options, repeats, best, mean, stats);
+        cout << left << setw(28) << instance.name << setw(10) << engineName(engine)
+             << right << setw(10) << stats.nodes << setw(10) << stats.probes << setw(12) << best << setw(12) << mean << endl;
+    }
+}
+
+static void scaleThreads(const Instance& instance, int repeats, int maxThreads, long tableKb) {
+    double baseline = 0;
+    for (int threads = 1; threads <= maxThreads; threads++) {
+        SolveOptions options;
+        options.engine = ENGINE_PARALLEL;
+        options.threads = threads;
+        options.nogoodKb = tableKb;
+        SolveStats stats;
+        double best, mean;
+        timeSolve(instance, options, repeats, best, mean, stats);
+        if (threads == 1) baseline = best;
+        cout << left << setw(28) << instance.name << right << setw(8) << threads << setw(12) << stats.nodes
+             << setw(12) << best << setw(12) << mean << setw(10) << (best > 0 ? baseline / best : 0) << endl;
+    }
+}
+
+static void compareNogoods(const Instance& instance, int repeats, long tableKb) {
+    for (SolveEngine engine : { ENGINE_INDEXED, ENGINE_ITERATIVE }) {
+        SolveOptions options;
+        options.engine = engine;
+        SolveStats plain, learned;
+        double plainBest, learnedBest, mean;
+        timeSolve(instance, options, repeats, plainBest, mean, plain);
+        options.nogoodKb = tableKb;
+        timeSolve(instance, options, repeats, learnedBest, mean, learned);
+        const NogoodTable::Stats& table = learned.nogoods;
+        cout << left << setw(28) << instance.name << setw(10) << engineName(engine) << right
+             << setw(10) << plain.nodes << setw(10) << learned.nodes
+             << setw(10) << (plain.nodes ? 100.0 * (plain.nodes - learned.nodes) / plain.nodes : 0)
+             << setw(10) << table.lookups << setw(10) << (table.lookups ? 100.0 * table.hits / table.lookups : 0)
+             << setw(10) << table.evictions << setw(12) << plainBest << setw(12) << learnedBest << endl;
+    }
+}
+
+// peak resident set size of this process in kilobytes, 0 where unsupported
+static long peakMemoryKb() {
+#ifndef _WIN32
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#ifdef __APPLE__
+        return usage.ru_maxrss / 1024;  // bytes on macOS
+#else
+        return usage.ru_maxrss;
+#endif
+    }
+#endif
+    return 0;
+}
+
+// one solve of a fresh copy of instance, cancelled by a watchdog after budgetMs
+static void suiteRun(const Instance& instance, SolveEngine engine, int budgetMs) {
+    Puzzle puzzle = instance.puzzle;
+    Vector<Tile> tiles = instance.tiles;
+    SolveStats stats;
+    atomic<bool> cancel(false);
+    SolveOptions options;
+    options.engine = engine;
+    options.stats = &stats;
+    options.cancel = &cancel;
+
+    mutex lock;
+    condition_variable done;
+    bool finished = false;
+    thread watchdog([&]() {
+        unique_lock<mutex> guard(lock);
+        if (!done.wait_for(guard, chrono::milliseconds(budgetMs), [&]() { return finished; })) {
+            cancel = true;
+        }
+    });
+    auto start = chrono::steady_clock::now();
+    bool found = solve(puzzle, tiles, options);
+    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    {
+        lock_guard<mutex> guard(lock);
+        finished = true;
+    }
+    done.notify_one();
+    watchdog.join();
+
+    // the flag may be raised just after an unsolved search ended, only a cancel the search saw is a timeout
+    string status = found ? "solved" : (stats.cancelled ? "timeout" : "unsolvable");
+    cout << instance.name << '\t' << engineName(engine) << '\t' << status << '\t'
+         << stats.nodes << '\t' << stats.probes << '\t';
+    if (found) cout << ms; else cout << '-';
+    cout << '\t' << (ms > 0 ? long(stats.nodes * 1000.0 / ms) : 0) << '\t' << peakMemoryKb() << endl;
+}
+
+static int runSuite(string puzzleDir, Vector<SolveEngine> engines, Vector<int> labelCounts, int budgetMs) {
+    if (engines.isEmpty()) engines.add(ENGINE_INDEXED);
+    if (labelCounts.isEmpty()) labelCounts = { 3, 6 };
+    Vector<string> files;
+    if (isDirectory(puzzleDir)) gatherPuzzleFiles(puzzleDir, files, false, "malformed");
+    sort(files.begin(), files.end());
+
+    cout << fixed << setprecision(3);
+    cout << "instance\tengine\tstatus\tnodes\tprobes\tfirst_ms\tnodes_per_sec\tpeak_kb" << endl;
+    for (const string& file : files) {
+        Instance instance;
+        string reason;
+        if (!loadPuzzleFile(file, instance.puzzle, instance.tiles, reason)) {
+            cerr << file << ": error: " << reason << endl;
+            continue;
+        }
+        instance.name = file;
+        for (SolveEngine engine : engines) suiteRun(instance, engine, budgetMs);
+    }
+    for (int labels : labelCounts) {
+        for (int size = kSuiteMinSize; size <= kSuiteMaxSize; size++) {
+            Instance instance;
+            generateInstance(integerToString(size) + "x" + integerToString(size) + ":" + integerToString(labels), instance);
+            for (SolveEngine engine : engines) suiteRun(instance, engine, budgetMs);
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    int repeats = kDefaultRepeats;
+    int maxThreads = 0;
+    long tableKb = 0;
+    bool suite = false;
+    string puzzleDir = "puzzles";
+    Vector<SolveEngine> engines;
+    Vector<int> labelCounts;
+    int budgetMs = kDefaultBudgetMs;
+    Vector<Instance> instances;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "-s") {
+            suite = true;
+        } else if (arg == "-e" && i + 1 < argc) {
+            SolveEngine engine;
+            if (!engineForName(argv[++i], engine)) {
+                cerr << "Unknown engine " << argv[i] << endl;
+                return 2;
+            }
+            engines.add(engine);
+        } else if (arg == "-l" && i + 1 < argc) {
+            for (const string& count : stringSplit(argv[++i], ",")) {
+                labelCounts.add(max(1, stringToInteger(count)));
+            }
+        } else if (arg == "-b" && i + 1 < argc) {
+            budgetMs = max(1, stringToInteger(argv[++i]));
+        } else if (arg == "-r" && i + 1 < argc) {
+            repeats = max(1, stringToInteger(argv[++i]));
+        } else if (arg == "-t" && i + 1 < argc) {
+            maxThreads = max(1, stringToInteger(argv[++i]));
+        } else if (arg == "-n" && i + 1 < argc) {
+            tableKb = max(1, stringToInteger(argv[++i]));
+        } else if (arg == "-g" && i + 1 < argc) {
+            Instance instance;
+            int rows, cols, labels;
+            unsigned seed;
+            instance.source = argv[++i];
+            instance.synthetic = true;
+            if (!parseSpec(instance.source, rows, cols, labels, seed)) {
+                cerr << "Bad synthetic spec " << argv[i] << ", expected RxC[:labels[:seed]]" << endl;
+                return 2;
+            }
+            instances.add(instance);
+        } else if (suite) {
+            puzzleDir = arg;
+        } else {
+            Instance instance;
+            instance.source = arg;
+            instance.name = arg.substr(arg.find_last_of('/') + 1);
+            instances.add(instance);
+        }
+    }
+    if (suite) return runSuite(puzzleDir, engines, labelCounts, budgetMs);
+    if (instances.isEmpty()) {
+        for (string file : { "puzzles/tens/tens.txt", "puzzles/dogs/dogs.txt", "puzzles/ocean/ocean.txt" }) {
+            Instance instance;
+            instance.source = file;
+            instance.name = file.substr(file.find_last_of('/') + 1);
+            instances.add(instance);
+        }
+    }
+
+    cout << fixed << setprecision(4);
+    if (maxThreads > 0) {
+        cout << left << setw(28) << "instance" << right << setw(8) << "threads" << setw(12) << "nodes"
+             << setw(12) << "best ms" << setw(12) << "mean ms" << setw(10) << "speedup" << endl;
+        for (Instance& instance : instances) {
+            if (loadInstance(instance)) scaleThreads(instance, repeats, maxThreads, tableKb);
+        }
+    } else if (tableKb > 0) {
+        cout << left << setw(28) << "instance" << setw(10) << "engine" << right << setw(10) << "nodes"
+             << setw(10) << "w/ table" << setw(10) << "saved %" << setw(10) << "lookups" << setw(10) << "hit %"
+             << setw(10) << "evicted" << setw(12) << "best ms" << setw(12) << "w/ table" << endl;
+        for (Instance& instance : instances) {
+            if (loadInstance(instance)) compareNogoods(instance, repeats, tableKb);
+        }
+    } else {
+        cout << left << setw(28) << "instance" << setw(10) << "engine" << right << setw(10) << "nodes"
+             << setw(10) << "probes" << setw(12) << "best ms" << setw(12) << "mean ms" << endl;
+        for (Instance& instance : instances) {
+            if (loadInstance(instance)) compareEngines(instance, repeats);
+        }
+    }
+    return 0;
+}
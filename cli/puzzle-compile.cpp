@@ -0,0 +1,53 @@
+/*
+ * File: puzzle-compile.cpp
+ * ------------------------
+ * Compiles puzzle configuration files to the binary .tpb format read by
+ * loadPuzzleBinary (see PuzzleBinary.h), so batch runs skip text parsing.
+ * A directory argument stands for every .txt config found beneath it.
+ *
+ *     puzzle-compile [-i] [-o out.tpb] puzzles/cola/cola.txt puzzles/dogs ...
+ *
+ * Each config is written next to itself with its extension replaced by .tpb.
+ * -i also stores the tile image paths, relative to the config's folder.
+ * -o names the output file; only allowed with a single config.
+ */
+#include <iostream>
+#include <string>
+#include "PuzzleBinary.h"
+#include "PuzzleConfig.h"
+#include "filelib.h"
+#include "strlib.h"
+#include "vector.h"
+
+using namespace std;
+
+int main(int argc, char* argv[]) {
+    bool includeImages = false;
+    string outFile;
+    Vector<string> files;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "-i") includeImages = true;
+        else if (arg == "-o" && i + 1 < argc) outFile = argv[++i];
+        else gatherPuzzleFiles(arg, files);
+    }
+    if (files.isEmpty() || (!outFile.empty() && files.size() != 1)) {
+        cerr << "usage: " << argv[0] << " [-i] [-o out" << kPuzzleBinaryExtension << "] config.txt|directory ..." << endl;
+        return 2;
+    }
+
+    int numErrors = 0;
+    for (const string& file : files) {
+        PuzzleConfig config;
+        string reason;
+        string target = outFile.empty() ? file.substr(0, file.size() - getExtension(file).size()) + kPuzzleBinaryExtension : outFile;
+        if (!readPuzzleConfig(file, config, reason)
+            || !writePuzzleBinary(target, config, getHead(file), includeImages, reason)) {
+            cout << file << ": error: " << reason << endl;
+            numErrors++;
+            continue;
+        }
+        cout << file << ": wrote " << target << endl;
+    }
+    return numErrors > 0 ? 1 : 0;
+}
@@ -1,6 +1,6 @@
 #include "console.h"
 #include "vector.h"
-#include "puzzle-solve.h"
+#include "tile-match.h"
 #include <iostream>
 using namespace std;
 
@@ -3,42 +3,33 @@
  * 10/31/24
  * puzzle-solve.cpp
  *
- * This file implements a puzzle-solving system for a tile-based puzzle game. The program
- * interacts with the user to load puzzle configurations, run an interactive puzzle-solving
- * session, and attempt to solve the puzzle using recursive backtracking. It uses the
- * Puzzle class to manage the grid and checks if tiles can be placed on the grid.
+ * This file implements the solver for a tile-based puzzle game using recursive
+ * backtracking. It uses the Puzzle class to manage the grid and checks if tiles
+ * can be placed on the grid. Nothing in this file depends on the GUI, progress
+ * is reported through the optional observer in SolveOptions.
  */
 
 #include "puzzle-solve.h"
 #include "Puzzle.h"
-#include "PuzzleGUI.h"
+#include "CandidateFilter.h"
+#include "CandidateIndex.h"
+#include "DancingLinks.h"
+#include "FixedSolver.h"
+#include "IterativeSearch.h"
+#include "PuzzleConfig.h"
+#include "PuzzleGenerator.h"
+#include "TileBitset.h"
+#include "WorkStealingPool.h"
+#include "strlib.h"
 #include "SimpleTest.h"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <mutex>
 
 using namespace std;
 
-void tileMatch(string puzzleFile) {
-    Puzzle puzzle;
-    Vector<Tile> tiles;
-    Action action;
-
-    loadPuzzleConfig(puzzleFile, puzzle, tiles);
-    updateDisplay(puzzle, tiles);
-
-    do {
-        action = playInteractive(puzzle, tiles);
-        if (action == LOAD_NEW) {
-            string configFile = chooseFileDialog();
-            loadPuzzleConfig(configFile, puzzle, tiles);
-            updateDisplay(puzzle, tiles);
-        } else if (action == RUN_SOLVE) {
-            bool success = solve(puzzle, tiles);
-            cout << "Found solution to puzzle? " << boolalpha << success << endl;
-            updateDisplay(puzzle, tiles);
-        }
-    } while (action != QUIT);
-}
-
-bool solve(Puzzle& puzzle, Vector<Tile>& tileVec) {
+static bool solveVector(Puzzle& puzzle, Vector<Tile>& tileVec, const SolveOptions& options) {
     if (tileVec.isEmpty())
     {
         return true;
@@ -46,17 +37,20 @@ bool solve(Puzzle& puzzle, Vector<Tile>& tileVec) {
 
     for (int k = tileVec.size() - 1; k >= 0; k--)
     {
+        if (cancelRequested(options)) return false;
         Tile tile = tileVec.get(k);
         tileVec.remove(k);
         for (int i = 0; i < 4; i++)
         {
             tile.rotate();
+            if (options.stats) options.stats->probes++;
             if(puzzle.canAdd(tile))
             {
                 puzzle.add(tile);
-                updateDisplay(puzzle, tileVec);
+                if (options.stats) options.stats->nodes++;
+                if (options.observer) options.observer(puzzle, tileVec);
 
-                solve(puzzle, tileVec);
+                solveVector(puzzle, tileVec, options);
 
                 if(puzzle.isFull())
                 {
@@ -64,7 +58,7 @@ bool solve(Puzzle& puzzle, Vector<Tile>& tileVec) {
                 }
 
                 puzzle.remove();
-                updateDisplay(puzzle, tileVec);
+                if (options.observer) options.observer(puzzle, tileVec);
             }
         }
         tileVec.add(tile);
@@ -72,3 +66,865 @@ bool solve(Puzzle& puzzle, Vector<Tile>& tileVec) {
 
     return puzzle.isFull();
 }
+
+/*
+ * State shared by every level of the bitset search. Tile ids are indexes into
+ * pool, and remaining holds the ids of the tiles not yet on the board.
+ */
+struct BitsetSearch {
+    Puzzle& puzzle;
+    const SolveOptions& options;
+    Vector<Tile> pool;
+    TileBitset remaining;
+    const CandidateIndex* index;  // only used by the indexed engines
+    const atomic<bool>* stop;     // set by another worker once a solution is found
+    NogoodTable* nogoods = nullptr;  // only used by the indexed and parallel engines
+    const CandidateFilter* filter = nullptr;  // only used by the bitset and mrv engines
+    long placements = 0;
+};
+
+static bool isStopped(const BitsetSearch& search) {
+    return (search.stop && search.stop->load(memory_order_relaxed)) || cancelRequested(search.options);
+}
+
+// a solved board leaves only the tiles still in remaining, any spares, in tileVec
+static void keepUnplaced(Vector<Tile>& tileVec, const TileBitset& remaining) {
+    Vector<Tile> unplaced;
+    for (int id = 0; id < tileVec.size(); id++) {
+        if (remaining.contains(id)) unplaced.add(tileVec[id]);
+    }
+    tileVec = unplaced;
+}
+
+// the observer is given a Vector, so only build one when there is an observer
+static void notifyBitset(const BitsetSearch& search) {
+    Vector<Tile> tiles;
+    for (int id = 0; id < search.pool.size(); id++) {
+        if (search.remaining.contains(id)) tiles.add(search.pool[id]);
+    }
+    search.options.observer(search.puzzle, tiles);
+}
+
+/*
+ * Same search as solveVector, but taking a tile from the pool and returning
+ * it are single bit operations, and the tiles are always tried in id order.
+ * Which (tile, rotation) pairs fit the next cell is worked out for the whole
+ * pool at once by the CandidateFilter rather than by canAdd per pair.
+ */
+static bool solveBitset(BitsetSearch& search) {
+    if (search.puzzle.isFull()) return true;  // any tiles still in remaining are spares
+    if (isStopped(search)) return false;
+    TileBitset fits[NUM_SIDES];  // by quarter turns from the pool orientation
+    search.filter->match(search.puzzle, search.puzzle.nextLocation(), fits);
+    for (int w = 0; w < TileBitset::kNumWords; w++) {
+        for (uint64_t bits = search.remaining.word(w); bits; bits &= bits - 1) {
+            int id = w * 64 + TileBitset::lowestBit(bits);
+            Tile tile = search.pool[id];
+            search.remaining.remove(id);
+            for (int i = 0; i < NUM_SIDES; i++) {
+                tile.rotate();
+                if (search.options.stats) search.options.stats->probes++;
+                if (fits[(i + 1) % NUM_SIDES].contains(id)) {
+                    search.puzzle.add(tile);
+                    if (search.options.stats) search.options.stats->nodes++;
+                    if (search.options.observer) notifyBitset(search);
+                    if (solveBitset(search)) return true;
+                    search.puzzle.remove();
+                    if (search.options.observer) notifyBitset(search);
+                }
+            }
+            search.remaining.add(id);
+        }
+    }
+    return false;
+}
+
+// forward check after the tile just placed, when the options ask for it
+static bool neighborsFillable(const BitsetSearch& search) {
+    return !search.options.forwardCheck
+           || search.index->canFillNeighbors(search.puzzle, search.puzzle.lastPlaced(), search.remaining);
+}
+
+/*
+ * Row-major fill means the next cell only has neighbors to the north and west,
+ * so the index hands back exactly the candidates that fit there. The only
+ * filtering left is skipping tiles that are already on the board, plus a full
+ * edge check if the board was handed over with cells filled out of order.
+ */
+static bool solveIndexed(BitsetSearch& search) {
+    if (search.puzzle.isFull()) return true;  // any tiles still in remaining are spares
+    if (isStopped(search)) return false;
+    bool checkEdges = !search.puzzle.isFilledInOrder(); // cells east or south may be filled too
+    bool useNogoods = search.nogoods && !checkEdges;
+    long placementsBefore = search.placements;
+    if (useNogoods && search.nogoods->contains(search.puzzle, search.remaining)) return false;
+    int count;
+    const CandidateIndex::Candidate* run = search.index->candidatesFor(search.puzzle, count);
+    for (int i = 0; i < count; i++) {
+        const CandidateIndex::Candidate& candidate = run[i];
+        if (!search.remaining.contains(candidate.id)) continue;
+        if (search.options.stats) search.options.stats->probes++;
+        if (checkEdges && !search.puzzle.canAdd(candidate.tile)) continue;
+        search.remaining.remove(candidate.id);
+        search.puzzle.add(candidate.tile);
+        search.placements++;
+        if (search.options.stats) search.options.stats->nodes++;
+        if (search.options.observer) notifyBitset(search);
+        if (neighborsFillable(search) && solveIndexed(search)) return true;
+        search.puzzle.remove();
+        if (search.options.observer) notifyBitset(search);
+        search.remaining.add(candidate.id);
+    }
+    // a stopped search has not really failed here
+    if (useNogoods && !isStopped(search)) {
+        search.nogoods->record(search.puzzle, search.remaining, search.placements - placementsBefore);
+    }
+    return false;
+}
+
+/*
+ * Most-constrained-cell search. Rather than filling in row-major order, each
+ * step counts the (tile, rotation) candidates that fit every empty cell and
+ * branches on the cell with the fewest. A cell with no candidates left means
+ * the branch is dead no matter how the other cells would be filled.
+ */
+static const int kNoLimit = NUM_SIDES * MAX_TILES + 1;
+
+// candidates that fit loc, counting stops once limit is reached
+static int countFits(const BitsetSearch& search, GridLocation loc, int limit) {
+    TileBitset fits[NUM_SIDES];
+    search.filter->match(search.puzzle, loc, fits);
+    int count = 0;
+    for (int turn = 0; turn < NUM_SIDES && count < limit; turn++) {
+        for (int w = 0; w < TileBitset::kNumWords; w++) {
+            count += __builtin_popcountll(fits[turn].word(w) & search.remaining.word(w));
+        }
+    }
+    return count;
+}
+
+static bool solveMrv(BitsetSearch& search) {
+    if (search.puzzle.isFull()) return true;  // any tiles still in remaining are spares
+    if (isStopped(search)) return false;
+    GridLocation best;
+    int bestCount = kNoLimit;
+    for (int row = 0; row < search.puzzle.numRows(); row++) {
+        for (int col = 0; col < search.puzzle.numCols(); col++) {
+            GridLocation loc(row, col);
+            if (!search.puzzle.tileAt(loc).isBlank()) continue;
+            int count = countFits(search, loc, bestCount);
+            if (count == 0) return false;
+            if (count < bestCount) {
+                best = loc;
+                bestCount = count;
+            }
+        }
+    }
+    TileBitset fits[NUM_SIDES];
+    search.filter->match(search.puzzle, best, fits);
+    for (int w = 0; w < TileBitset::kNumWords; w++) {
+        for (uint64_t bits = search.remaining.word(w); bits; bits &= bits - 1) {
+            int id = w * 64 + TileBitset::lowestBit(bits);
+            Tile tile = search.pool[id];
+            search.remaining.remove(id);
+            for (int i = 0; i < NUM_SIDES; i++) {
+                tile.rotate();
+                if (search.options.stats) search.options.stats->probes++;
+                if (!fits[(i + 1) % NUM_SIDES].contains(id)) continue;
+                search.puzzle.add(tile, best);
+                if (search.options.stats) search.options.stats->nodes++;
+                if (search.options.observer) notifyBitset(search);
+                if (solveMrv(search)) return true;
+                search.puzzle.remove();
+                if (search.options.observer) notifyBitset(search);
+            }
+            search.remaining.add(id);
+        }
+    }
+    return false;
+}
+
+/*
+ * Parallel search. The top of the tree is expanded breadth-first on the calling
+ * thread until there are enough boards to keep every worker busy; each board
+ * reached is kept as a BoardState snapshot with the tiles it has left. Each
+ * becomes a task that restores the snapshot into its worker's own board and
+ * runs the indexed search below it. The first task to fill its board raises
+ * the shared stop flag, which every other task polls once per node. With
+ * options.nogoodKb each worker has a table of that size, shared by the tasks
+ * it runs; a dead end is one whichever prefix led to it.
+ */
+static const int kTasksPerThread = 8;
+static const int kMaxSplitDepth = 6;
+
+template <class State>
+struct SplitBoard {
+    State board;
+    TileBitset remaining;
+};
+
+template <class State>
+static bool solveParallelFrom(Puzzle& puzzle, Vector<Tile>& tileVec, const SolveOptions& options) {
+    CandidateIndex index(puzzle, tileVec);
+    WorkStealingPool pool(options.threads);
+    Vector<SplitBoard<State>> frontier(1);
+    puzzle.snapshot(frontier[0].board);
+    for (int id = 0; id < tileVec.size(); id++) {
+        frontier[0].remaining.add(id);
+    }
+
+    Puzzle scratch = puzzle;  // each board of the frontier is restored into it to be extended
+    for (int depth = 0; depth < kMaxSplitDepth && frontier.size() < pool.numThreads() * kTasksPerThread; depth++) {
+        Vector<SplitBoard<State>> next;
+        for (const SplitBoard<State>& split : frontier) {
+            scratch.restore(split.board);
+            if (scratch.isFull()) {
+                puzzle.restore(split.board); // solved during the split
+                keepUnplaced(tileVec, split.remaining);
+                return true;
+            }
+            int count;
+            const CandidateIndex::Candidate* run = index.candidatesFor(scratch, count);
+            for (int i = 0; i < count; i++) {
+                if (!split.remaining.contains(run[i].id)) continue;
+                if (!scratch.isFilledInOrder() && !scratch.canAdd(run[i].tile)) continue;
+                next.add(split);
+                scratch.add(run[i].tile);
+                scratch.snapshot(next[next.size() - 1].board);
+                scratch.remove();
+                next[next.size() - 1].remaining.remove(run[i].id);
+                if (options.stats) options.stats->nodes++;
+            }
+        }
+        if (next.isEmpty()) return false;
+        frontier = next;
+    }
+
+    atomic<bool> stop(false);
+    mutex resultLock;
+    bool found = false;
+    State solution;
+    TileBitset unplaced;
+    Vector<Puzzle> boards(pool.numThreads(), puzzle);  // one per worker, reused by its tasks
+    Vector<NogoodTable> nogoods;                       // one per worker too, if asked for
+    for (int worker = 0; options.nogoodKb > 0 && worker < pool.numThreads(); worker++) {
+        nogoods.add(NogoodTable(options.nogoodKb, puzzle.numCols()));
+    }
+    for (int task = 0; task < frontier.size(); task++) {
+        pool.submit([&, task]() {
+            if (stop.load(memory_order_relaxed)) return;
+            SolveStats local;
+            SolveOptions taskOptions = options;  // the caller's search settings, such as forwardCheck
+            taskOptions.stats = &local;
+            taskOptions.observer = nullptr;
+            taskOptions.profile = nullptr;       // each task records into its own, merged below
+            int worker = pool.currentWorker();
+            Puzzle& board = boards[worker];
+            board.restore(frontier[task].board);
+            BitsetSearch search = { board, taskOptions, tileVec, frontier[task].remaining, &index, &stop };
+            if (!nogoods.isEmpty()) search.nogoods = &nogoods[worker];
+            SolveProfile profile;
+            if (options.profile) profile.start(board.numFilled());
+            bool solved = solveIndexed(search);
+            if (options.profile) profile.stop();
+            lock_guard<mutex> guard(resultLock);
+            if (options.profile) options.profile->merge(profile);
+            if (options.stats) {
+                options.stats->nodes += local.nodes;
+                options.stats->probes += local.probes;
+                if (local.cancelled) options.stats->cancelled = true;
+            }
+            if (solved && !found) {
+                found = true;
+                board.snapshot(solution);
+                unplaced = search.remaining;
+                stop = true;
+            }
+        });
+    }
+    pool.wait();
+    if (options.stats) {
+        for (const NogoodTable& table : nogoods) options.stats->nogoods += table.stats();
+    }
+    if (!found) return false;
+    puzzle.restore(solution);
+    keepUnplaced(tileVec, unplaced);
+    return true;
+}
+
+// boards of up to 6x6 are split with the compact BoardState
+static bool solveParallel(Puzzle& puzzle, Vector<Tile>& tileVec, const SolveOptions& options) {
+    if (BoardState::fits(puzzle.numRows(), puzzle.numCols())) {
+        return solveParallelFrom<BoardState>(puzzle, tileVec, options);
+    }
+    return solveParallelFrom<LargeBoardState>(puzzle, tileVec, options);
+}
+
+/*
+ * Enumeration for countSolutions. The search is the indexed one, but it keeps
+ * going after a full board. Candidates of the pinned tile are skipped unless
+ * their rotation is in pinnedRotations (bit r set allows rotation r).
+ */
+struct CountSearch {
+    BitsetSearch search;
+    int pinnedId;
+    unsigned pinnedRotations;
+    SolutionVisitor visit;
+    long found;
+};
+
+static void enumerateIndexed(CountSearch& count) {
+    BitsetSearch& search = count.search;
+    if (search.puzzle.isFull()) {
+        if (search.remaining.isEmpty()) {
+            count.found++;
+            if (count.visit) count.visit(search.puzzle);
+        }
+        return;
+    }
+    int numCandidates;
+    const CandidateIndex::Candidate* run = search.index->candidatesFor(search.puzzle, numCandidates);
+    for (int i = 0; i < numCandidates; i++) {
+        const CandidateIndex::Candidate& candidate = run[i];
+        if (!search.remaining.contains(candidate.id)) continue;
+        if (candidate.id == count.pinnedId && !(count.pinnedRotations & (1u << candidate.tile.getRotation()))) continue;
+        if (!search.puzzle.isFilledInOrder() && !search.puzzle.canAdd(candidate.tile)) continue;
+        search.remaining.remove(candidate.id);
+        search.puzzle.add(candidate.tile);
+        search.options.stats->nodes++;
+        enumerateIndexed(count);
+        search.puzzle.remove();
+        search.remaining.add(candidate.id);
+    }
+}
+
+SolutionCount countSolutions(const Puzzle& puzzle, const Vector<Tile>& tiles, bool breakSymmetry, SolutionVisitor visit) {
+    if (tiles.size() > MAX_TILES) error("Solution counting supports at most " + integerToString(MAX_TILES) + " tiles");
+    auto start = chrono::steady_clock::now();
+    SolutionCount result;
+    // whole-board rotations only map the board onto itself when nothing is fixed yet
+    if (puzzle.isEmpty()) {
+        result.symmetry = (puzzle.numRows() == puzzle.numCols()) ? 4 : 2;
+    }
+    string reason;
+    if (!checkFeasible(puzzle, tiles, reason)) return result;
+    Puzzle board = puzzle;
+    SolveStats stats;
+    SolveOptions options;
+    options.stats = &stats;
+    CandidateIndex index(board, tiles);
+    CountSearch count = { { board, options, tiles, TileBitset(), &index, nullptr }, -1, 0, visit, 0 };
+    for (int id = 0; id < tiles.size(); id++) {
+        count.search.remaining.add(id);
+    }
+    // a quarter turn of the board turns every tile once more, a half turn twice, so
+    // each orbit has exactly one member with tile 0 at rotation 0 (or 0-1 for half turns)
+    if (breakSymmetry && result.symmetry > 1 && !tiles.isEmpty()) {
+        count.pinnedId = 0;
+        count.pinnedRotations = (result.symmetry == 4) ? 0x1 : 0x3;
+    }
+    enumerateIndexed(count);
+    if (count.pinnedId >= 0) {
+        result.unique = count.found;
+        result.raw = count.found * result.symmetry;
+    } else {
+        result.raw = count.found;
+        result.unique = count.found / result.symmetry;
+    }
+    result.nodes = stats.nodes;
+    result.elapsedMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+bool checkFeasible(const Puzzle& puzzle, const Vector<Tile>& tiles, string& reason) {
+    int numEmpty = puzzle.numRows() * puzzle.numCols() - puzzle.numFilled();
+    if (tiles.size() < numEmpty) {
+        reason = integerToString(tiles.size()) + " tiles for " + integerToString(numEmpty) + " empty cells";
+        return false;
+    }
+    if (tiles.size() > numEmpty) return true; // spare tiles may take any of the labels out of play
+
+    int counts[MAX_LABELS] = {};
+    auto countLabels = [&counts](const Tile& tile) {
+        for (Direction dir = NORTH; dir <= WEST; dir++) counts[tile.getEdgeId(dir)]++;
+    };
+    for (int row = 0; row < puzzle.numRows(); row++) {
+        for (int col = 0; col < puzzle.numCols(); col++) {
+            Tile tile = puzzle.tileAt(GridLocation(row, col));
+            if (!tile.isBlank()) countLabels(tile);
+        }
+    }
+    for (const Tile& tile : tiles) {
+        countLabels(tile);
+    }
+    int onBorder = 0;
+    for (int label = 0; label < MAX_LABELS; label++) {
+        int opposite = puzzle.complementOf(label);
+        if (opposite == label) onBorder += counts[label] % 2;
+        else if (puzzle.complementOf(opposite) != label) onBorder += counts[label]; // can never face a neighbor
+        else if (label < opposite) onBorder += abs(counts[label] - counts[opposite]);
+    }
+    int borderSides = 2 * (puzzle.numRows() + puzzle.numCols());
+    if (onBorder > borderSides) {
+        reason = "edge labels leave " + integerToString(onBorder) + " sides unmatched, the border has "
+                 + integerToString(borderSides);
+        return false;
+    }
+    return true;
+}
+
+bool solve(Puzzle& puzzle, Vector<Tile>& tileVec) {
+    return solveVector(puzzle, tileVec, SolveOptions());
+}
+
+static bool solveWithEngine(Puzzle& puzzle, Vector<Tile>& tileVec, const SolveOptions& options) {
+    if (options.engine == ENGINE_VECTOR) {
+        return solveVector(puzzle, tileVec, options);
+    }
+    if (options.engine == ENGINE_DLX) {
+        return solveExactCover(puzzle, tileVec, options);
+    }
+    if (tileVec.size() > MAX_TILES) error("Bitset solver supports at most " + integerToString(MAX_TILES) + " tiles");
+    if (options.engine == ENGINE_PARALLEL) {
+        return solveParallel(puzzle, tileVec, options);
+    }
+    if (options.engine == ENGINE_ITERATIVE) {
+        return solveIterative(puzzle, tileVec, options);
+    }
+    if (options.engine == ENGINE_FIXED) {
+        if (puzzle.isEmpty() && tileVec.size() == puzzle.numRows() * puzzle.numCols()
+            && hasFixedSolver(puzzle.numRows(), puzzle.numCols())) {
+            return solveFixed(puzzle, tileVec, options);
+        }
+        SolveOptions generic = options;
+        generic.engine = ENGINE_INDEXED;
+        return solveWithEngine(puzzle, tileVec, generic);
+    }
+    BitsetSearch search = { puzzle, options, tileVec, TileBitset(), nullptr, nullptr };
+    for (int id = 0; id < tileVec.size(); id++) {
+        search.remaining.add(id);
+    }
+    bool found;
+    if (options.engine == ENGINE_INDEXED) {
+        CandidateIndex index(puzzle, tileVec);
+        search.index = &index;
+        if (options.nogoodKb > 0) {
+            NogoodTable nogoods(options.nogoodKb, puzzle.numCols());
+            search.nogoods = &nogoods;
+            found = solveIndexed(search);
+            if (options.stats) options.stats->nogoods += nogoods.stats();
+        } else {
+            found = solveIndexed(search);
+        }
+    } else {
+        CandidateFilter filter(puzzle, tileVec);
+        search.filter = &filter;
+        found = (options.engine == ENGINE_MRV) ? solveMrv(search) : solveBitset(search);
+    }
+    if (!found) return false;
+    keepUnplaced(tileVec, search.remaining);
+    return true;
+}
+
+static bool solveCached(Puzzle& puzzle, Vector<Tile>& tileVec, const SolveOptions& options) {
+    string reason;
+    if (!checkFeasible(puzzle, tileVec, reason)) return false;
+    if (!options.cache || !puzzle.isEmpty()) return solveWithEngine(puzzle, tileVec, options);
+    string fingerprint;
+    if (options.cache->lookup(puzzle, tileVec, fingerprint)) return true;
+    bool found = solveWithEngine(puzzle, tileVec, options);
+    if (found) options.cache->store(fingerprint, puzzle);
+    return found;
+}
+
+bool solve(Puzzle& puzzle, Vector<Tile>& tileVec, const SolveOptions& options) {
+    if (!options.profile) return solveCached(puzzle, tileVec, options);
+    options.profile->start(puzzle.numFilled());
+    bool found = solveCached(puzzle, tileVec, options);
+    options.profile->stop();
+    return found;
+}
+
+/*
+ * The engines take a Vector; other collections of tiles are copied into one
+ * and afterwards hold whatever the engine left unplaced.
+ */
+template <typename Collection>
+static bool solveCollection(Puzzle& puzzle, Collection& tiles, const SolveOptions& options) {
+    Vector<Tile> tileVec;
+    for (const Tile& tile : tiles) {
+        tileVec.add(tile);
+    }
+    bool found = solve(puzzle, tileVec, options);
+    tiles.clear();
+    for (const Tile& tile : tileVec) {
+        tiles.add(tile);
+    }
+    return found;
+}
+
+bool solve(Puzzle& puzzle, Set<Tile>& tiles) {
+    SolveOptions options;
+    options.engine = ENGINE_FIXED;
+    return solveCollection(puzzle, tiles, options);
+}
+
+string engineName(SolveEngine engine) {
+    switch (engine) {
+        case ENGINE_VECTOR: return "vector";
+        case ENGINE_BITSET: return "bitset";
+        case ENGINE_INDEXED: return "indexed";
+        case ENGINE_PARALLEL: return "parallel";
+        case ENGINE_DLX: return "dlx";
+        case ENGINE_MRV: return "mrv";
+        case ENGINE_ITERATIVE: return "iterative";
+        case ENGINE_FIXED: return "fixed";
+    }
+    return "unknown";
+}
+
+bool engineForName(string name, SolveEngine& engine) {
+    for (SolveEngine cur : { ENGINE_VECTOR, ENGINE_BITSET, ENGINE_INDEXED, ENGINE_PARALLEL, ENGINE_DLX, ENGINE_MRV, ENGINE_ITERATIVE,
+                              ENGINE_FIXED }) {
+        if (engineName(cur) == name) {
+            engine = cur;
+            return true;
+        }
+    }
+    return false;
+}
+
+/* * * * * * Test Cases * * * * * */
+
+static void loadTestPuzzle(string file, Puzzle& puzzle, Vector<Tile>& tiles) {
+    string reason;
+    if (!loadPuzzleFile(file, puzzle, tiles, reason)) error(file + ": " + reason);
+}
+
+// a full board on which every edge matches, holding each of tiles once
+static bool isSolutionWith(const Puzzle& puzzle, const Vector<Tile>& tiles) {
+    if (!puzzle.isFull() || puzzle.numFilled() != tiles.size()) return false;
+    Set<Tile> unused;
+    for (const Tile& tile : tiles) {
+        unused.add(tile);
+    }
+    for (int row = 0; row < puzzle.numRows(); row++) {
+        for (int col = 0; col < puzzle.numCols(); col++) {
+            GridLocation loc(row, col);
+            Tile tile = puzzle.tileAt(loc);
+            if (!unused.contains(tile)) return false;
+            unused.remove(tile);
+            for (Direction dir = NORTH; dir <= WEST; dir++) {
+                if (!puzzle.canMatchEdge(tile, loc, dir)) return false;
+            }
+        }
+    }
+    return true;
+}
+
+STUDENT_TEST("countSolutions gives the same counts with and without symmetry breaking") {
+    struct Expected { string file; long raw; long unique; int symmetry; };
+    for (const Expected& expected : { Expected{ "puzzles/turtles/turtles.txt", 4, 1, 4 },
+                                      Expected{ "puzzles/cola/cola.txt", 8, 2, 4 },
+                                      Expected{ "puzzles/cola/cola_strip.txt", 6, 3, 2 } }) {
+        Puzzle puzzle;
+        Vector<Tile> tiles;
+        loadTestPuzzle(expected.file, puzzle, tiles);
+        long invalid = 0;
+        auto check = [&](const Puzzle& board) { if (!isSolutionWith(board, tiles)) invalid++; };
+        SolutionCount pinned = countSolutions(puzzle, tiles, true, check);
+        SolutionCount all = countSolutions(puzzle, tiles, false, check);
+        EXPECT_EQUAL(invalid, 0);
+        EXPECT_EQUAL(pinned.symmetry, expected.symmetry);
+        EXPECT_EQUAL(pinned.raw, expected.raw);
+        EXPECT_EQUAL(pinned.unique, expected.unique);
+        EXPECT_EQUAL(all.raw, expected.raw);
+        EXPECT_EQUAL(all.unique, expected.unique);
+        EXPECT(pinned.nodes < all.nodes);
+        EXPECT(puzzle.isEmpty());
+    }
+}
+
+// one solve of a copy of the board with options, returning the nodes it placed
+static long nodesToSolve(const Puzzle& puzzle, const Vector<Tile>& tiles, SolveOptions options, bool& solved) {
+    Puzzle board = puzzle;
+    Vector<Tile> remaining = tiles;
+    SolveStats stats;
+    options.stats = &stats;
+    solved = solve(board, remaining, options);
+    return stats.nodes;
+}
+
+STUDENT_TEST("dlx engine agrees with the indexed engine and keeps tiles already placed") {
+    for (string file : { "puzzles/turtles/turtles.txt", "puzzles/cola/cola.txt" }) {
+        Puzzle puzzle;
+        Vector<Tile> tiles;
+        loadTestPuzzle(file, puzzle, tiles);
+        Puzzle solution = puzzle;
+        Vector<Tile> unused = tiles;
+        SolveOptions options;
+        options.engine = ENGINE_INDEXED;
+        EXPECT(solve(solution, unused, options));
+
+        // two cells of that solution filled out of row-major order, the rest left to dlx
+        Puzzle board = puzzle;
+        Vector<Tile> remaining;
+        GridLocation fixed[] = { { 2, 2 }, { 0, 1 } };
+        for (GridLocation loc : fixed) {
+            board.add(solution.tileAt(loc), loc);
+        }
+        for (const Tile& tile : tiles) {
+            if (!(tile == solution.tileAt(fixed[0])) && !(tile == solution.tileAt(fixed[1]))) remaining.add(tile);
+        }
+        options.engine = ENGINE_DLX;
+        EXPECT(solve(board, remaining, options));
+        EXPECT(remaining.isEmpty());
+        EXPECT(isSolutionWith(board, tiles));
+        for (GridLocation loc : fixed) {
+            EXPECT(board.tileAt(loc) == solution.tileAt(loc));
+            EXPECT_EQUAL(board.tileAt(loc).getRotation(), solution.tileAt(loc).getRotation());
+        }
+
+        // two sides of one tile swapped keep the label counts but leave no solution for either engine
+        Tile first = tiles[0];
+        tiles[0] = Tile(first.getEdge(NORTH), first.getEdge(EAST), first.getEdge(WEST), first.getEdge(SOUTH));
+        bool indexedSolved, dlxSolved;
+        options.engine = ENGINE_INDEXED;
+        nodesToSolve(puzzle, tiles, options, indexedSolved);
+        options.engine = ENGINE_DLX;
+        nodesToSolve(puzzle, tiles, options, dlxSolved);
+        EXPECT_EQUAL(dlxSolved, indexedSolved);
+    }
+}
+
+STUDENT_TEST("fixed engine and the Set overload fill a valid board for every bundled cola size") {
+    for (string file : { "puzzles/turtles/turtles.txt", "puzzles/cola/cola.txt", "puzzles/cola/cola_row.txt",
+                         "puzzles/cola/cola_strip.txt", "puzzles/cola/cola_smaller.txt" }) {
+        Puzzle puzzle;
+        Vector<Tile> tiles;
+        loadTestPuzzle(file, puzzle, tiles);
+        EXPECT(hasFixedSolver(puzzle.numRows(), puzzle.numCols()));
+        Set<Tile> pool;
+        for (const Tile& tile : tiles) {
+            pool.add(tile);
+        }
+        EXPECT(solve(puzzle, pool));
+        EXPECT(pool.isEmpty());
+        EXPECT(isSolutionWith(puzzle, tiles));
+    }
+    // no fixed-size solver for 5x5, so ENGINE_FIXED falls back to the indexed search
+    Puzzle puzzle;
+    Vector<Tile> tiles;
+    generatePuzzle(5, 5, 4, 1, puzzle, tiles);
+    Vector<Tile> all = tiles;
+    SolveOptions options;
+    options.engine = ENGINE_FIXED;
+    EXPECT(!hasFixedSolver(5, 5));
+    EXPECT(solve(puzzle, tiles, options));
+    EXPECT(isSolutionWith(puzzle, all));
+}
+
+STUDENT_TEST("every engine solves turtles and cola, and the filter engines do the same search with the scalar kernel") {
+    string kernel = CandidateFilter::kernelName();
+    for (string file : { "puzzles/turtles/turtles.txt", "puzzles/cola/cola.txt" }) {
+        Puzzle puzzle;
+        Vector<Tile> tiles;
+        loadTestPuzzle(file, puzzle, tiles);
+        for (SolveEngine engine : { ENGINE_VECTOR, ENGINE_BITSET, ENGINE_INDEXED, ENGINE_PARALLEL, ENGINE_DLX, ENGINE_MRV,
+                                    ENGINE_ITERATIVE, ENGINE_FIXED }) {
+            Puzzle board = puzzle;
+            Vector<Tile> remaining = tiles;
+            SolveStats stats;
+            SolveOptions options;
+            options.engine = engine;
+            options.stats = &stats;
+            EXPECT(solve(board, remaining, options));
+            EXPECT(remaining.isEmpty());
+            EXPECT(isSolutionWith(board, tiles));
+            if (engine != ENGINE_BITSET && engine != ENGINE_MRV) continue;
+
+            Puzzle scalarBoard = puzzle;
+            remaining = tiles;
+            SolveStats scalarStats;
+            options.stats = &scalarStats;
+            EXPECT(CandidateFilter::selectKernel("scalar"));
+            EXPECT(solve(scalarBoard, remaining, options));
+            EXPECT(CandidateFilter::selectKernel(kernel));
+            EXPECT_EQUAL(scalarStats.nodes, stats.nodes);
+            EXPECT_EQUAL(scalarStats.probes, stats.probes);
+            for (int row = 0; row < board.numRows(); row++) {
+                for (int col = 0; col < board.numCols(); col++) {
+                    Tile ours = board.tileAt({ row, col }), scalar = scalarBoard.tileAt({ row, col });
+                    EXPECT(ours == scalar && ours.getRotation() == scalar.getRotation());
+                }
+            }
+        }
+    }
+}
+
+STUDENT_TEST("engines fill the board from a pool with one spare tile and hand the spare back") {
+    // the 1x3 row is filled before the parallel engine has finished splitting
+    for (string file : { "puzzles/cola/cola.txt", "puzzles/cola/cola_row.txt" }) {
+        Puzzle puzzle;
+        Vector<Tile> tiles;
+        loadTestPuzzle(file, puzzle, tiles);
+        Tile first = tiles[0];
+        Tile spare(first.getEdge(NORTH), first.getEdge(EAST), first.getEdge(WEST), first.getEdge(SOUTH));
+        Vector<Tile> pool = tiles;
+        pool.add(spare);
+        for (SolveEngine engine : { ENGINE_VECTOR, ENGINE_BITSET, ENGINE_INDEXED, ENGINE_PARALLEL, ENGINE_DLX, ENGINE_MRV,
+                                    ENGINE_ITERATIVE, ENGINE_FIXED }) {
+            Puzzle board = puzzle;
+            Vector<Tile> remaining = pool;
+            SolveOptions options;
+            options.engine = engine;
+            EXPECT(solve(board, remaining, options));
+            EXPECT_EQUAL(remaining.size(), 1);
+            Vector<Tile> placed = pool;
+            for (int i = 0; i < placed.size(); i++) {
+                if (!remaining.isEmpty() && placed[i] == remaining[0]) {
+                    placed.remove(i);
+                    break;
+                }
+            }
+            EXPECT(isSolutionWith(board, placed));
+        }
+    }
+}
+
+STUDENT_TEST("parallel engine solves from inside a worker of a larger pool") {
+    Puzzle puzzle;
+    Vector<Tile> tiles;
+    loadTestPuzzle("puzzles/cola/cola.txt", puzzle, tiles);
+    WorkStealingPool outer(4);
+    atomic<int> solved(0);
+    for (int task = 0; task < 4; task++) {
+        outer.submit([&]() {
+            Puzzle board = puzzle;
+            Vector<Tile> remaining = tiles;
+            SolveOptions options;
+            options.engine = ENGINE_PARALLEL;
+            options.threads = 1;  // fewer workers than the outer pool has
+            if (solve(board, remaining, options) && isSolutionWith(board, tiles)) solved++;
+        });
+    }
+    outer.wait();
+    EXPECT_EQUAL(solved.load(), 4);
+}
+
+STUDENT_TEST("parallel engine honours forwardCheck") {
+    Puzzle puzzle;
+    Vector<Tile> tiles;
+    loadTestPuzzle("puzzles/cola/cola.txt", puzzle, tiles);
+    // swapping two sides of one tile keeps the label counts but leaves no solution, so every
+    // task runs to the end and the node count does not depend on the order the tasks ran in
+    Tile first = tiles[0];
+    tiles[0] = Tile(first.getEdge(NORTH), first.getEdge(EAST), first.getEdge(WEST), first.getEdge(SOUTH));
+    SolveOptions options;
+    options.engine = ENGINE_PARALLEL;
+    options.threads = 2;
+    bool checkedSolved, uncheckedSolved;
+    long checked = nodesToSolve(puzzle, tiles, options, checkedSolved);
+    options.forwardCheck = false;
+    long unchecked = nodesToSolve(puzzle, tiles, options, uncheckedSolved);
+    EXPECT(!checkedSolved);
+    EXPECT(!uncheckedSolved);
+    EXPECT(unchecked > checked);
+}
+
+STUDENT_TEST("checkFeasible turns down too few tiles or a surplus of one label, and passes solvable puzzles") {
+    for (string file : { "puzzles/turtles/turtles.txt", "puzzles/cola/cola.txt", "puzzles/cola/cola_strip.txt" }) {
+        Puzzle puzzle;
+        Vector<Tile> tiles;
+        loadTestPuzzle(file, puzzle, tiles);
+        string reason;
+        EXPECT(checkFeasible(puzzle, tiles, reason));
+
+        Vector<Tile> fewer = tiles;
+        fewer.remove(0);
+        EXPECT(!checkFeasible(puzzle, fewer, reason));
+        EXPECT(reason != "");
+
+        // every side of every tile shows the same label, so none of them can face its complement
+        LabelId label = tiles[0].getEdgeId(NORTH);
+        EXPECT(puzzle.complementOf(label) != label);
+        Vector<Tile> surplus;
+        for (int i = 0; i < tiles.size(); i++) {
+            surplus.add(Tile(label, label, label, label));
+        }
+        reason = "";
+        EXPECT(!checkFeasible(puzzle, surplus, reason));
+        EXPECT(reason != "");
+        Puzzle board = puzzle;
+        EXPECT(!solve(board, surplus, SolveOptions()));
+        EXPECT(board.isEmpty());
+    }
+}
+
+STUDENT_TEST("forward checking prunes the indexed search without changing its answer") {
+    Puzzle puzzle;
+    Vector<Tile> tiles;
+    loadTestPuzzle("puzzles/cola/cola.txt", puzzle, tiles);
+    Vector<Tile> broken = tiles;
+    Tile first = broken[0];
+    broken[0] = Tile(first.getEdgeId(NORTH), first.getEdgeId(EAST), first.getEdgeId(WEST), first.getEdgeId(SOUTH));
+    for (const Vector<Tile>& pool : { tiles, broken }) {
+        SolveOptions options;
+        options.engine = ENGINE_INDEXED;
+        bool checkedSolved, uncheckedSolved;
+        long checked = nodesToSolve(puzzle, pool, options, checkedSolved);
+        options.forwardCheck = false;
+        long unchecked = nodesToSolve(puzzle, pool, options, uncheckedSolved);
+        EXPECT_EQUAL(checkedSolved, uncheckedSolved);
+        EXPECT(checked <= unchecked);
+    }
+    SolveOptions options;
+    options.engine = ENGINE_INDEXED;
+    bool solved;
+    long checked = nodesToSolve(puzzle, broken, options, solved);
+    options.forwardCheck = false;
+    EXPECT(!solved);
+    EXPECT(checked < nodesToSolve(puzzle, broken, options, solved));
+}
+
+STUDENT_TEST("a dead-end table leaves the indexed and iterative answers unchanged and never adds nodes") {
+    struct Case { Puzzle puzzle; Vector<Tile> tiles; };
+    Vector<Case> cases;
+    for (string file : { "puzzles/turtles/turtles.txt", "puzzles/cola/cola.txt", "puzzles/dogs/dogs.txt" }) {
+        Case c;
+        loadTestPuzzle(file, c.puzzle, c.tiles);
+        cases.add(c);
+    }
+    Case broken = cases[1];
+    Tile first = broken.tiles[0];
+    broken.tiles[0] = Tile(first.getEdgeId(NORTH), first.getEdgeId(EAST), first.getEdgeId(WEST), first.getEdgeId(SOUTH));
+    cases.add(broken);
+    Case generated;
+    generatePuzzle(4, 4, 4, 7, generated.puzzle, generated.tiles);
+    cases.add(generated);
+
+    for (const Case& c : cases) {
+        for (SolveEngine engine : { ENGINE_INDEXED, ENGINE_ITERATIVE }) {
+            SolveOptions options;
+            options.engine = engine;
+            Puzzle plainBoard = c.puzzle;
+            Vector<Tile> plainTiles = c.tiles;
+            SolveStats plain;
+            options.stats = &plain;
+            bool plainSolved = solve(plainBoard, plainTiles, options);
+
+            options.nogoodKb = 64;
+            Puzzle board = c.puzzle;
+            Vector<Tile> tiles = c.tiles;
+            SolveStats withTable;
+            options.stats = &withTable;
+            bool solved = solve(board, tiles, options);
+
+            EXPECT_EQUAL(solved, plainSolved);
+            if (solved) EXPECT(isSolutionWith(board, c.tiles));
+            EXPECT(withTable.nodes <= plain.nodes);
+            EXPECT(withTable.nogoods.lookups > 0);
+            EXPECT_EQUAL(plain.nogoods.lookups, 0);
+        }
+    }
+}
@@ -1,8 +1,174 @@
-// tile-match
+// tile-match solver, no GUI dependencies
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <string>
+#include "NogoodTable.h"
 #include "Puzzle.h"
+#include "SolutionCache.h"
+#include "SolveProfile.h"
 #include "set.h"
+#include "vector.h"
+
+/**
+ * SolveObserver
+ * -------------
+ * Called by the solver after every tile it adds to or removes from the board,
+ * with the current board and the tiles not yet placed. The GUI passes one
+ * that redraws the display; headless callers leave it empty.
+ */
+typedef std::function<void(const Puzzle&, const Vector<Tile>&)> SolveObserver;
+
+/**
+ * SolveEngine
+ * -----------
+ * Which search implementation solve() runs.
+ *   ENGINE_VECTOR  the original backtracker, removes and re-adds tiles in the Vector
+ *   ENGINE_BITSET  same search, unused tiles kept in a TileBitset indexed by tile id
+ *   ENGINE_INDEXED bitset pool, and each cell only walks the (tile, rotation) candidates
+ *                  that a CandidateIndex lists for its north and west neighbors
+ *   ENGINE_PARALLEL indexed search split into one task per shallow placement prefix,
+ *                  run on a WorkStealingPool; the observer is not called
+ *   ENGINE_DLX     exact cover with dancing links (see DancingLinks.h); nodes counts the
+ *                  rows chosen, probes the rows in the matrix; the observer is not called
+ *   ENGINE_MRV     bitset pool, but each step fills the empty cell with the fewest fitting
+ *                  candidates and fails at once when any empty cell has none
+ *   ENGINE_ITERATIVE indexed search with an explicit stack of per-cell frames instead of
+ *                  recursion, for large boards (see IterativeSearch.h)
+ *   ENGINE_FIXED   row-major search compiled for the board size (see FixedSolver.h) when the
+ *                  empty board has one of the built-in sizes, ENGINE_INDEXED otherwise; the
+ *                  fixed-size path does not call the observer
+ */
+enum SolveEngine { ENGINE_VECTOR, ENGINE_BITSET, ENGINE_INDEXED, ENGINE_PARALLEL, ENGINE_DLX, ENGINE_MRV, ENGINE_ITERATIVE,
+                   ENGINE_FIXED };
+
+/**
+ * SolveStats
+ * ----------
+ * Counters filled in by the solver when SolveOptions.stats is set.
+ * nodes is the number of tiles placed on the board during the search,
+ * probes the number of (tile, rotation) pairs considered for a cell.
+ * nogoods counts the use of the dead-end tables when SolveOptions.nogoodKb is set.
+ * cancelled is set when the search saw SolveOptions.cancel and gave up, so a
+ * caller can tell that from a search that ran to the end without a solution.
+ */
+struct SolveStats {
+    long nodes = 0;
+    long probes = 0;
+    NogoodTable::Stats nogoods;
+    bool cancelled = false;
+};
+
+/**
+ * SolveOptions
+ * ------------
+ * Settings for a run of the solver. The defaults run the plain recursive
+ * backtracker with no observer and no statistics. If cancel is set, the
+ * search polls it once per node and solve() gives up and returns false once
+ * another thread stores true, with the board and tiles unwound to how they
+ * were handed in. If profile is set, it is started and stopped around the
+ * run (see SolveProfile.h). If cache is set and the board starts empty, a
+ * verified cached solution is used without searching, and a solution found
+ * by the search is stored for next time (see SolutionCache.h). forwardCheck
+ * makes the indexed, parallel and iterative engines backtrack as soon as a
+ * placement leaves an empty neighboring cell with no candidate. nogoodKb
+ * gives the indexed and iterative engines a table of that many kilobytes, and
+ * each worker of the parallel engine one of its own, in which they record
+ * positions that failed, so a search that reaches the same position again
+ * backtracks at once (see NogoodTable.h).
+ */
+struct SolveOptions {
+    SolveEngine engine = ENGINE_VECTOR;
+    SolveObserver observer;
+    SolveStats* stats = nullptr;
+    int threads = 0;    // ENGINE_PARALLEL workers, 0 for one per hardware thread
+    const std::atomic<bool>* cancel = nullptr;
+    SolveProfile* profile = nullptr;
+    SolutionCache* cache = nullptr;
+    bool forwardCheck = true;
+    long nogoodKb = 0;  // 0 for no table
+};
+
+/**
+ * cancelRequested
+ * ---------------
+ * The poll of options.cancel made by every engine. Once it returns true the
+ * engine gives up, so it also marks options.stats as cancelled.
+ */
+inline bool cancelRequested(const SolveOptions& options) {
+    if (!options.cancel || !options.cancel->load(std::memory_order_relaxed)) return false;
+    if (options.stats) options.stats->cancelled = true;
+    return true;
+}
+
+/**
+ * engineName / engineForName
+ * --------------------------
+ * Translate between a SolveEngine and its lowercase name for command-line
+ * tools, e.g. "vector", "bitset", "indexed". engineForName returns false for an unknown name.
+ */
+std::string engineName(SolveEngine engine);
+bool engineForName(std::string name, SolveEngine& engine);
+
+/**
+ * checkFeasible
+ * -------------
+ * Cheap test run by solve() and countSolutions before any search. Every
+ * interior edge of a solution joins a label to its complement, so counting
+ * the labels on the board and the tiles gives the fewest tile sides that must
+ * face the border: the surplus of each label over its complement, every label
+ * with no complement, and one of an odd count of a self-matching label. If
+ * that exceeds the 2 * (rows + cols) border sides, or there are fewer tiles
+ * than empty cells, there is no solution. Returns false and sets reason then;
+ * true means only that the search has to decide.
+ */
+bool checkFeasible(const Puzzle& puzzle, const Vector<Tile>& tiles, std::string& reason);
 
 bool solve(Puzzle&, Vector<Tile>&);
+bool solve(Puzzle&, Vector<Tile>&, const SolveOptions& options);
+
+/**
+ * solve (Set overload)
+ * --------------------
+ * Solves with the tiles held in a Set, using ENGINE_FIXED. The tiles are
+ * handed to the engines as a Vector and the Set is left holding the tiles
+ * that were not placed, none on success.
+ */
 bool solve(Puzzle&, Set<Tile>&);
 
-void tileMatch(std::string puzzleFile);
+/**
+ * SolutionCount
+ * -------------
+ * Result of countSolutions. Rotating a solved board as a whole gives another
+ * solution, so solutions come in orbits of size symmetry: 4 on a square
+ * board, 2 (half turn) on any other shape, 1 if the board was partly filled
+ * before counting. raw counts every full board, unique counts orbits.
+ */
+struct SolutionCount {
+    long raw = 0;
+    long unique = 0;
+    int symmetry = 1;
+    long nodes = 0;
+    double elapsedMs = 0;
+};
+
+/**
+ * SolutionVisitor
+ * ---------------
+ * Called by countSolutions with the full board for each unique solution.
+ */
+typedef std::function<void(const Puzzle&)> SolutionVisitor;
+
+/**
+ * countSolutions
+ * --------------
+ * Enumerates every solution reachable from the current board with tiles.
+ * With breakSymmetry the orientation of one canonical tile is pinned so
+ * that the search visits one representative per orbit and raw is computed
+ * as unique * symmetry. Without it every full board is visited and unique is
+ * raw / symmetry, which is useful for checking the pinned count.
+ * puzzle and tiles are not modified.
+ */
+SolutionCount countSolutions(const Puzzle& puzzle, const Vector<Tile>& tiles, bool breakSymmetry = true,
+                             SolutionVisitor visit = nullptr);
@@ -0,0 +1,49 @@
+###############################################################################
+# GUI-free solver library: config parsing, Puzzle, Tile and the solver.
+# Included by the headless tools under cli/. Backtracking.pro picks up the
+# same files through its glob, so GUI and tools compile identical sources.
+###############################################################################
+
+INCLUDEPATH += $$PWD
+
+# solver instrumentation (SolveProfile.h) is compiled out unless asked for:
+#   qmake CONFIG+=solver_profile
+solver_profile: DEFINES += PUZZLE_PROFILE
+
+HEADERS *= \
+    $$PWD/Tile.h \
+    $$PWD/Puzzle.h \
+    $$PWD/BoardState.h \
+    $$PWD/CandidateFilter.h \
+    $$PWD/CandidateIndex.h \
+    $$PWD/DancingLinks.h \
+    $$PWD/FixedSolver.h \
+    $$PWD/IterativeSearch.h \
+    $$PWD/LocalSearch.h \
+    $$PWD/NogoodTable.h \
+    $$PWD/PuzzleBinary.h \
+    $$PWD/PuzzleConfig.h \
+    $$PWD/PuzzleGenerator.h \
+    $$PWD/SolutionCache.h \
+    $$PWD/SolveProfile.h \
+    $$PWD/TileBitset.h \
+    $$PWD/WorkStealingPool.h \
+    $$PWD/puzzle-solve.h
+
+SOURCES *= \
+    $$PWD/Tile.cpp \
+    $$PWD/Puzzle.cpp \
+    $$PWD/CandidateFilter.cpp \
+    $$PWD/CandidateIndex.cpp \
+    $$PWD/DancingLinks.cpp \
+    $$PWD/FixedSolver.cpp \
+    $$PWD/IterativeSearch.cpp \
+    $$PWD/LocalSearch.cpp \
+    $$PWD/NogoodTable.cpp \
+    $$PWD/PuzzleBinary.cpp \
+    $$PWD/PuzzleConfig.cpp \
+    $$PWD/PuzzleGenerator.cpp \
+    $$PWD/SolutionCache.cpp \
+    $$PWD/SolveProfile.cpp \
+    $$PWD/WorkStealingPool.cpp \
+    $$PWD/puzzle-solve.cpp
@@ -0,0 +1,138 @@
+/*
+ * Joseph Le
+ * 10/31/24
+ * tile-match.cpp
+ *
+ * This file drives the graphical tile-match program. It interacts with the user
+ * to load puzzle configurations, run an interactive puzzle-solving session, and
+ * run the solver while animating its progress on the display.
+ */
+
+#include "tile-match.h"
+#include "puzzle-solve.h"
+#include "Puzzle.h"
+#include "PuzzleGUI.h"
+#include "SnapshotQueue.h"
+#include "TileBitset.h"
+#include "SimpleTest.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+using namespace std;
+
+static const string kSolutionCacheDir = "solution-cache";
+
+/*
+ * Copy of the board and the remaining tiles taken by the solver thread. Fixed
+ * arrays rather than collections so publishing one never allocates.
+ */
+struct BoardSnapshot {
+    Tile cells[MAX_TILES];      // row-major, blank for an empty cell
+    Tile remaining[MAX_TILES];
+    int numCells = 0;
+    int numRemaining = 0;
+};
+
+static void takeSnapshot(const Puzzle& puzzle, const Vector<Tile>& remaining, BoardSnapshot& snapshot) {
+    snapshot.numCells = 0;
+    for (int row = 0; row < puzzle.numRows(); row++) {
+        for (int col = 0; col < puzzle.numCols(); col++) {
+            snapshot.cells[snapshot.numCells++] = puzzle.tileAt(GridLocation(row, col));
+        }
+    }
+    snapshot.numRemaining = remaining.size();
+    for (int i = 0; i < remaining.size(); i++) {
+        snapshot.remaining[i] = remaining[i];
+    }
+}
+
+// brings board and remaining up to date with snapshot, touching only the cells that changed
+static void applySnapshot(const BoardSnapshot& snapshot, Puzzle& board, Vector<Tile>& remaining) {
+    for (int i = 0; i < snapshot.numCells; i++) {
+        GridLocation loc(i / board.numCols(), i % board.numCols());
+        Tile current = board.tileAt(loc), wanted = snapshot.cells[i];
+        if (current == wanted && current.getRotation() == wanted.getRotation()) continue;
+        if (!current.isBlank()) board.remove(loc);
+        if (!wanted.isBlank()) board.add(wanted, loc);
+    }
+    remaining.clear();
+    for (int i = 0; i < snapshot.numRemaining; i++) {
+        remaining.add(snapshot.remaining[i]);
+    }
+}
+
+/*
+ * Runs the solver on a worker thread. Its observer publishes a snapshot into a
+ * SnapshotQueue after every step, replacing any not yet drawn, and this
+ * thread draws the latest one once per frame until the solver is done.
+ */
+static bool solveAnimated(Puzzle& puzzle, Vector<Tile>& tiles, SolveOptions options, const AnimationOptions& animation) {
+    int numCells = puzzle.numRows() * puzzle.numCols();
+    if (numCells > MAX_TILES || tiles.size() > MAX_TILES) {
+        return solve(puzzle, tiles, options);  // too big to snapshot, show the result only
+    }
+    SnapshotQueue<BoardSnapshot> queue;
+    options.observer = [&queue](const Puzzle& p, const Vector<Tile>& remaining) {
+        takeSnapshot(p, remaining, *queue.claim());
+        queue.publish();
+    };
+
+    Puzzle board = puzzle;
+    Vector<Tile> remaining = tiles;
+    atomic<bool> finished(false);
+    bool found = false;
+    thread worker([&]() {
+        found = solve(puzzle, tiles, options);
+        finished = true;
+    });
+
+    chrono::milliseconds frame(1000 / max(1, animation.framesPerSecond));
+    BoardSnapshot latest;
+    while (!finished) {
+        chrono::steady_clock::time_point next = chrono::steady_clock::now() + frame;
+        if (queue.popLatest(latest)) {
+            applySnapshot(latest, board, remaining);
+            updateDisplay(board, remaining);
+        }
+        this_thread::sleep_until(next);
+    }
+    worker.join();
+    return found;
+}
+
+void tileMatch(string puzzleFile, AnimationOptions animation) {
+    Puzzle puzzle;
+    Vector<Tile> tiles;
+    Action action;
+
+    loadPuzzleConfig(puzzleFile, puzzle, tiles);
+    updateDisplay(puzzle, tiles);
+
+    SolutionCache cache(kSolutionCacheDir);
+    SolveOptions options;
+    options.cache = &cache;
+    if (animation.step) {
+        int pauseMs = animation.stepPauseMs;
+        options.observer = [pauseMs](const Puzzle& p, const Vector<Tile>& remaining) { updateDisplay(p, remaining, pauseMs); };
+    }
+
+    do {
+        action = playInteractive(puzzle, tiles);
+        if (action == LOAD_NEW) {
+            string configFile = chooseFileDialog();
+            loadPuzzleConfig(configFile, puzzle, tiles);
+            updateDisplay(puzzle, tiles);
+        } else if (action == RUN_SOLVE) {
+            options.cancel = beginCancelableSolve();
+            bool success = animation.step ? solve(puzzle, tiles, options)
+                                          : solveAnimated(puzzle, tiles, options, animation);
+            endCancelableSolve();
+            if (options.cancel->load()) cout << "Solve canceled" << endl;
+            else cout << "Found solution to puzzle? " << boolalpha << success << endl;
+            cout << "Solution cache: " << cache.stats().hits << " of " << cache.stats().lookups << " lookups hit, "
+                 << cache.stats().averageLookupMs() << " ms per lookup" << endl;
+            updateDisplay(puzzle, tiles);
+        }
+    } while (action != QUIT);
+}
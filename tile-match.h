@@ -0,0 +1,22 @@
+// tile-match GUI driver
+#pragma once
+
+#include <string>
+
+/**
+ * AnimationOptions
+ * ----------------
+ * How the solver is shown while it runs. By default the search runs on a
+ * worker thread and the board is redrawn from its latest snapshot at most
+ * framesPerSecond times a second, so the search is not slowed to the speed of
+ * the display. In step mode the solver runs on the GUI thread and the board is
+ * redrawn after every tile added or removed, pausing stepPauseMs each time,
+ * which is the slow-motion view for demonstrating backtracking.
+ */
+struct AnimationOptions {
+    int framesPerSecond = 30;
+    bool step = false;
+    int stepPauseMs = 0;
+};
+
+void tileMatch(std::string puzzleFile, AnimationOptions animation = AnimationOptions());